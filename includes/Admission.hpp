@@ -0,0 +1,103 @@
+#ifndef ADMISSION_HPP
+# define ADMISSION_HPP
+
+# include <string>       // Pour les préfixes et les lignes du rapport
+# include <vector>       // Pour les lignes du rapport
+# include <stdint.h>     // Pour uint8_t et uint64_t
+# include <sys/socket.h> // Pour struct sockaddr
+
+// Fichier des règles d'admission (même principe que bot_config.txt)
+# define ADMISSION_CONFIG_FILE "admission_config.txt"
+// Connexions simultanées par adresse sans fichier de règles (0 = illimité)
+# define ADMISSION_DEFAULT_PER_IP 10
+// Longueur d'une adresse en bits (IPv4 rangée dans ::ffff:0:0/96)
+# define ADMISSION_ADDRESS_BITS 128
+
+// Adresse IPv4 ou IPv6 sur 16 octets, ordre réseau
+struct IpAddress
+{
+    uint8_t         bytes[16];
+};
+
+// Action d'une règle portée par un préfixe
+enum AdmissionAction
+{
+    ADMISSION_NONE,     // Nœud sans règle (embranchement ou compteur d'une adresse)
+    ADMISSION_ALLOW,    // Toujours admis, exempté des limites et du débit
+    ADMISSION_DENY,     // Toujours refusé
+    ADMISSION_LIMIT     // Nombre de connexions simultanées borné pour tout le préfixe
+};
+
+// Nœud de l'arbre de préfixes compressé (Patricia): seuls les embranchements sont stockés
+struct AdmissionNode
+{
+    IpAddress       key;            // Préfixe (bits au-delà de `bits` à zéro)
+    unsigned int    bits;           // Longueur du préfixe
+    AdmissionNode*  parent;
+    AdmissionNode*  child[2];
+    AdmissionAction action;         // Règle portée par ce préfixe
+    unsigned int    limit;          // Connexions permises (ADMISSION_LIMIT)
+    unsigned int    connections;    // Connexions ouvertes dans le préfixe (ADMISSION_LIMIT)
+    unsigned int    hostConnections; // Connexions ouvertes par cette adresse exacte (/128)
+    unsigned long   admitted;       // Connexions admises par cette règle
+    unsigned long   rejected;       // Connexions refusées par cette règle
+};
+
+// Contrôle d'admission consulté à l'acceptation, avant toute allocation d'un Client:
+// règles allow/deny/limit par préfixe CIDR, limite par adresse et débit global d'acceptation
+class Admission
+{
+private:
+    AdmissionNode*  _root;          // Racine de l'arbre (NULL si vide)
+    unsigned long   _nodes;         // Nœuds alloués
+    unsigned int    _perIpLimit;    // Connexions simultanées par adresse (0 = illimité)
+    unsigned long   _perIpRejected; // Refus dus à la limite par adresse
+    unsigned int    _rate;          // Acceptations par seconde (0 = illimité)
+    unsigned int    _burst;         // Capacité du seau de jetons
+    uint64_t        _tokens;        // Jetons disponibles, en millièmes
+    uint64_t        _lastRefill;    // Dernier remplissage du seau (µs)
+    unsigned long   _rateRejected;  // Refus dus au débit global
+    unsigned long   _admitted;      // Connexions admises
+
+    AdmissionNode* createNode(const IpAddress& key, unsigned int bits, AdmissionNode* parent);
+    AdmissionNode* insert(const IpAddress& address, unsigned int bits);
+    void erase(AdmissionNode* node);
+    void destroy(AdmissionNode* node);
+    unsigned int collectRules(const IpAddress& address, AdmissionNode** path, AdmissionNode** host) const;
+    bool takeToken();
+    void describe(const AdmissionNode* node, std::vector<std::string>& lines) const;
+
+    static bool testBit(const IpAddress& address, unsigned int bit);
+    static unsigned int commonBits(const IpAddress& a, const IpAddress& b, unsigned int max);
+    static void maskAddress(IpAddress& address, unsigned int bits);
+
+    Admission(const Admission&);
+    Admission& operator=(const Admission&);
+
+public:
+    // Constructeur et destructeur
+    Admission();
+    ~Admission();
+
+    // Configuration
+    void load(const std::string& path);
+    bool addRule(const std::string& prefix, AdmissionAction action, unsigned int limit);
+    void setPerIpLimit(unsigned int limit);
+    void setRate(unsigned int perSecond, unsigned int burst);
+
+    // Acceptation et fermeture d'une connexion
+    bool admit(const IpAddress& address);
+    void release(const IpAddress& address);
+
+    // Conversions d'adresses
+    static bool fromSockaddr(const struct sockaddr* addr, IpAddress& address);
+    static bool parsePrefix(const std::string& text, IpAddress& address, unsigned int& bits);
+    static std::string formatAddress(const IpAddress& address);
+    static std::string formatPrefix(const IpAddress& address, unsigned int bits);
+
+    // Rapport (STATS i) et comptabilité mémoire
+    std::vector<std::string> toLines() const;
+    size_t getMemoryUsage() const;
+};
+
+#endif
@@ -75,6 +75,9 @@ public:
     void time(Client* client);
     void joke(Client* client);
     void stats(Client* client);
+    
+    // Comptabilité mémoire
+    size_t getMemoryUsage() const;
 };
 
 #endif
\ No newline at end of file
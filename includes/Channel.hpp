@@ -10,13 +10,18 @@
 
 class Client;
 
+// Variantes de la réponse NAMES: combinaisons de CAP_MULTI_PREFIX et CAP_USERHOST_IN_NAMES
+# define NAMES_VARIANTS 4
+
 // Enumération des modes de canal
 enum ChannelMode 
 {
     MODE_INVITE_ONLY = 0x01,    // Mode invite (+i) - Canal sur invitation uniquement
     MODE_TOPIC_LOCKED = 0x02,   // Mode topic (+t) - Seuls les opérateurs peuvent changer le topic
     MODE_PASSWORD = 0x04,       // Mode key (+k) - Canal protégé par mot de passe
-    MODE_USER_LIMIT = 0x08      // Mode limit (+l) - Limite d'utilisateurs
+    MODE_USER_LIMIT = 0x08,     // Mode limit (+l) - Limite d'utilisateurs
+    MODE_SECRET = 0x10,         // Mode secret (+s) - Canal absent de LIST et WHOIS pour les non-membres
+    MODE_PRIVATE = 0x20         // Mode privé (+p) - Canal absent de LIST pour les non-membres
 };
 
 // Enumération des modes utilisateur dans un canal
@@ -31,12 +36,17 @@ class Channel
 private:
     std::string                     _name;           // Nom du canal
     std::string                     _topic;          // Sujet du canal
+    time_t                          _topicTime;      // Horodatage du dernier changement de sujet (0 si jamais)
     std::map<Client*, unsigned int> _clients;        // Clients dans le canal et leurs modes
     unsigned int                    _modes;          // Modes du canal
     std::string                     _password;       // Mot de passe du canal (si mode +k)
     unsigned int                    _userLimit;      // Limite d'utilisateurs (si mode +l)
     std::set<std::string>           _invitedUsers;   // Liste des utilisateurs invités (si mode +i)
     time_t                          _creationTime;   // Horodatage de création du canal
+    std::map<Client*, std::string>  _namesEntries[NAMES_VARIANTS]; // Entrées 353 déjà formatées, par variante
+    bool                            _namesValid[NAMES_VARIANTS]; // Variante construite (tenue à jour membre par membre)
+    
+    std::string namesEntry(Client* client, unsigned int modes, unsigned int variant) const;
     
 public:
     // Constructeur et destructeur
@@ -47,6 +57,7 @@ public:
     const std::string& getName() const;
     const std::string& getTopic() const;
     void setTopic(const std::string& topic, Client* setter);
+    time_t getTopicTime() const;
     unsigned int getModes() const;
     const std::string& getPassword() const;
     void setPassword(const std::string& password);
@@ -76,14 +87,28 @@ public:
     void inviteUser(const std::string& nickname);
     bool isInvited(const std::string& nickname) const;
     void removeInvite(const std::string& nickname);
+    unsigned int getInviteCount() const;
     
     // Diffusion de messages
     void broadcast(const std::string& message, Client* exclude = NULL);
+    size_t broadcastStamped(const std::string& message, unsigned long generation);
+    
+    // Réponse NAMES (353/366) en cache
+    const std::map<Client*, std::string>& getNamesEntries(unsigned int variant);
+    void refreshNames(Client* client);
+    void invalidateNames();
+    void sendNames(Client* client);
     
     // Vérifications de permissions
     bool clientCanJoin(Client* client, const std::string& password) const;
     bool clientCanChangeTopic(Client* client) const;
     
+    // Comptabilité mémoire
+    size_t getMemoryUsage() const;
+    size_t getMembersMemory() const;
+    size_t getInvitesMemory() const;
+    size_t getTopicMemory() const;
+    
     // Conversion en string pour l'affichage
     std::string toString() const;
 };
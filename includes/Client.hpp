@@ -3,14 +3,63 @@
 
 # include <string>       // Pour les chaînes de caractères
 # include <vector>       // Pour stocker des collections de données
-# include <queue>        // Pour la file de messages
+# include <queue>        // Pour la file des réponses longues
+# include <deque>        // Pour les files de messages (parcourues pour les envois groupés)
+# include <list>         // Pour la liste des connexions non enregistrées
 # include <iostream>     // Pour les entrées/sorties standard
+# include <ctime>        // Pour l'heure de connexion
 
 # include "Server.hpp"
 # include "Channel.hpp"
+# include "ReplyStream.hpp"
+# include "Tracer.hpp"
+# include "TimerWheel.hpp"
+# include "Admission.hpp"
 
 class Server;
 class Channel;
+class ReplyStream;
+class Listener;
+
+// Messages au plus regroupés dans un seul appel sendmsg
+# define SEND_IOV_BATCH 64
+// Taille maximum de chaque voie de la file d'envoi avant déconnexion du client (en octets)
+# define MAX_SENDQ 1048576
+# define MAX_SENDQ_PRIORITY 262144
+// Délai pour terminer l'enregistrement après la connexion (en millisecondes)
+# define REGISTRATION_TIMEOUT_MS 60000
+// Buffer de réception maximum tant que le client n'est pas enregistré (en octets)
+# define PREREG_RECVQ_MAX 512
+// Inactivité au-delà de laquelle le serveur envoie un PING (en millisecondes)
+# define KEEPALIVE_INTERVAL_MS 120000
+// Délai accordé pour répondre au PING (en millisecondes)
+# define PONG_TIMEOUT_MS 60000
+// Contrôle de flood: chaque point de coût d'une commande ajoute FLOOD_PENALTY_MS de pénalité,
+// les lignes restent dans le buffer tant que la pénalité dépasse FLOOD_BURST_MS
+# define FLOOD_PENALTY_MS 500
+# define FLOOD_BURST_MS 5000
+// Buffer de réception maximum (lignes retenues comprises) avant déconnexion "Excess Flood"
+# define MAX_RECVQ 8192
+// Longueur d'une ligne IRC, préfixe du serveur et CRLF compris (découpage des réponses en liste)
+# define IRC_LINE_MAX 512
+// Pseudos surveillés au plus par client (annoncé par MONITOR dans 005)
+# define MONITOR_MAX_TARGETS 100
+
+// Capacités IRCv3 négociées par CAP (les deux premières choisissent la variante de NAMES)
+enum ClientCap
+{
+    CAP_MULTI_PREFIX = 0x01,        // multi-prefix: tous les préfixes de statut (@+)
+    CAP_USERHOST_IN_NAMES = 0x02    // userhost-in-names: nick!user@host dans NAMES
+};
+// Capacités annoncées par CAP LS
+# define CAP_SUPPORTED "multi-prefix userhost-in-names"
+
+// Rôle d'un timer de client
+enum ClientTimerKind
+{
+    CLIENT_TIMER_KEEPALIVE,     // Délai d'enregistrement, puis PING et délai du PONG
+    CLIENT_TIMER_FLOOD          // Reprise des lignes retenues par le contrôle de flood
+};
 
 // Énumération des différents états d'un client
 enum ClientStatus 
@@ -21,6 +70,35 @@ enum ClientStatus
     DISCONNECTED     // Déconnecté (arrêté ou erreur)
 };
 
+// Voies de la file d'envoi: la voie prioritaire est toujours vidée avant la diffusion
+enum OutputLane
+{
+    LANE_PRIORITY,  // Réponses aux commandes du client, PING/PONG, ERROR
+    LANE_BULK,      // Messages diffusés (canaux, messages d'autres clients)
+    LANE_COUNT
+};
+
+// Message en attente d'envoi, rattaché à la ligne tracée qui l'a produit
+struct OutgoingMessage
+{
+    std::string     data;       // Message complet (avec \r\n) ou reste à envoyer
+    uint32_t        traceId;    // Identifiant de trace (0 si non tracé)
+};
+
+class Client;
+
+// Timer d'un client, prévient le client à l'échéance selon son rôle
+class ClientTimer : public Timer
+{
+private:
+    Client*         _client;    // Client propriétaire
+    ClientTimerKind _kind;      // Rôle du timer
+
+public:
+    ClientTimer(Client* client, ClientTimerKind kind);
+    virtual void expire();
+};
+
 class Client 
 {
 private:
@@ -28,16 +106,49 @@ private:
     std::string     _nickname;          // Pseudo du client
     std::string     _username;          // Nom d'utilisateur
     std::string     _hostname;          // Nom d'hôte
+    IpAddress       _address;           // Adresse comptée par le contrôle d'admission
+    bool            _admitted;          // _address est comptée (à libérer à la fermeture)
+    Listener*       _listener;          // Port sur lequel la connexion a été reçue (NULL pour le bot)
     std::string     _realname;          // Nom réel
     std::string     _buffer;            // Buffer de réception des messages
     ClientStatus    _status;            // État du client
     Server*         _server;            // Pointeur vers le serveur
     std::vector<Channel*> _channels;    // Canaux auxquels le client est connecté
-    std::queue<std::string> _messages;  // File d'attente des messages à envoyer
+    std::vector<std::string> _whoisChannels; // Entrées 319 déjà préfixées (canaux non secrets)
+    bool            _whoisValid;        // _whoisChannels à jour
+    bool            _whoisSecret;       // Au moins un canal secret, à filtrer selon le demandeur
+    std::deque<OutgoingMessage> _messages[LANE_COUNT]; // Files d'attente des messages à envoyer, par voie
+    unsigned int    _corked;            // Envois différés jusqu'à uncork (réponses groupées)
     std::string     _away_message;      // Message d'absence (bonus)
     bool            _isAway;            // Client absent ou non (bonus)
     bool            _isOperator;        // Client est opérateur global
-    std::string     _lastPong;          // Temps du dernier PONG reçu pour le PING
+    std::string     _quitMessage;       // Raison annoncée aux autres membres à la fermeture
+    unsigned long   _fanoutStamp;       // Dernier événement diffusé à ce client (QUIT, NICK)
+    unsigned int    _caps;              // Capacités CAP activées (ClientCap)
+    std::vector<std::string> _monitored; // Pseudos surveillés par MONITOR (minuscules)
+    bool            _online;            // Présence annoncée aux observateurs MONITOR
+    bool            _capNegotiating;    // CAP LS/REQ reçu avant l'enregistrement, en attente de CAP END
+    uint64_t        _lastPong;          // Horloge monotone du dernier PONG reçu (µs)
+    uint64_t        _pingSentAt;        // Horloge monotone du dernier PING envoyé (µs)
+    bool            _awaitingPong;      // PING envoyé, PONG pas encore reçu
+    ClientTimer     _timer;             // Enregistrement puis keepalive
+    ClientTimer     _floodTimer;        // Reprise des lignes retenues
+    uint64_t        _floodTime;         // Horloge de pénalité (ms), en avance sur l'heure si le client floode
+    unsigned long   _floodDeferrals;    // Fois où des lignes ont été retenues
+    bool            _runnable;          // Dans la file des clients à reprendre au prochain tour
+    bool            _pending;           // Présent dans la liste des connexions non enregistrées
+    std::list<Client*>::iterator _pendingPos; // Position dans cette liste
+    size_t          _sendQ;             // Octets en attente dans _messages (toutes voies)
+    size_t          _laneSendQ[LANE_COUNT]; // Octets en attente par voie
+    bool            _bulkPartial;       // Un message de diffusion est à moitié écrit sur le socket
+    std::queue<ReplyStream*> _streams;  // Réponses longues en cours d'émission
+    time_t          _connectTime;       // Heure de connexion
+    time_t          _lastActive;        // Dernière commande autre que PING/PONG (inactivité WHOIS)
+    unsigned long   _messagesSent;      // Messages envoyés au client
+    unsigned long   _bytesSent;         // Octets envoyés au client
+    unsigned long   _messagesReceived;  // Messages reçus du client
+    unsigned long   _bytesReceived;     // Octets reçus du client
+    uint64_t        _lastRecvTime;      // Horloge monotone du dernier recv (µs)
     
 public:
     // Constructeur et destructeur
@@ -52,12 +163,35 @@ public:
     void setUsername(const std::string& username);
     const std::string& getHostname() const;
     void setHostname(const std::string& hostname);
+    const IpAddress& getAddress() const;
+    void setAddress(const IpAddress& address);
+    bool isAdmitted() const;
+    Listener* getListener() const;
+    void setListener(Listener* listener);
+    std::string getConnectionClass() const;
     const std::string& getRealname() const;
     void setRealname(const std::string& realname);
     ClientStatus getStatus() const;
     void setStatus(ClientStatus status);
     bool isOperator() const;
     void setOperator(bool op);
+    const std::string& getQuitMessage() const;
+    void setQuitMessage(const std::string& message);
+    unsigned long getFanoutStamp() const;
+    void setFanoutStamp(unsigned long stamp);
+    bool hasCap(ClientCap cap) const;
+    unsigned int getCaps() const;
+    void setCaps(unsigned int caps);
+    bool isNegotiatingCaps() const;
+    void setNegotiatingCaps(bool negotiating);
+    bool isOnline() const;
+    
+    // Liste MONITOR (l'index inverse est tenu par le serveur)
+    const std::vector<std::string>& getMonitored() const;
+    bool isMonitoring(const std::string& key) const;
+    void addMonitored(const std::string& key);
+    void removeMonitored(const std::string& key);
+    void clearMonitored();
     
     // Gestion du buffer de réception
     void appendToBuffer(const std::string& data);
@@ -71,15 +205,72 @@ public:
     bool isInChannel(const std::string& channelName) const;
     std::vector<Channel*> getChannels() const;
     
+    // Liste des canaux de WHOIS (319), reconstruite seulement après un changement
+    void invalidateWhois();
+    const std::vector<std::string>& getWhoisChannels();
+    bool hasSecretChannels();
+    
     // Communication
-    void sendMessage(const std::string& message);
+    void sendMessage(const std::string& message, OutputLane lane = LANE_PRIORITY);
     void sendReply(const std::string& reply);
+    void sendReplyList(const std::string& head, const std::vector<std::string>& items, char separator,
+                       bool emptyLine = false);
     void sendNotice(const std::string& notice);
     void processMessages();
+    void cork();
+    void uncork();
+    size_t getSendQ() const;
+    size_t getSendQ(OutputLane lane) const;
+    
+    // Réponses longues émises par morceaux
+    void addStream(ReplyStream* stream);
+    bool hasStreams() const;
+    bool pumpStreams();
+    
+    // Statistiques de la connexion
+    time_t getConnectTime() const;
+    void recordActivity();
+    time_t getIdleTime() const;
+    unsigned long getMessagesSent() const;
+    unsigned long getBytesSent() const;
+    unsigned long getMessagesReceived() const;
+    unsigned long getBytesReceived() const;
+    size_t getRecvQ() const;
+    void recordReceivedBytes(size_t bytes);
+    uint64_t getLastRecvTime() const;
+    void recordReceivedMessage();
+    
+    // Comptabilité mémoire
+    size_t getMemoryUsage() const;
+    size_t getRecvQMemory() const;
+    size_t getSendQMemory() const;
+    size_t getSendQMessages() const;
     
     // Fonctions d'état
     bool isRegistered() const;
     
+    // Keepalive (PING/PONG) et délai d'enregistrement
+    void onTimer();
+    void recordPong();
+    
+    // Contrôle de flood
+    bool isFloodExempt() const;
+    uint64_t chargeFlood(unsigned int cost);
+    void addFloodPenalty(unsigned int cost);
+    void deferLines(uint64_t delayMs);
+    void onFloodTimer();
+    unsigned long getFloodDeferrals() const;
+    uint64_t getFloodPenalty() const;
+    
+    // Ordonnancement équitable entre clients
+    bool isRunnable() const;
+    void setRunnable(bool runnable);
+    
+    // Position dans la liste des connexions non enregistrées (gérée par le serveur)
+    bool isPending() const;
+    void setPending(bool pending, std::list<Client*>::iterator pos);
+    std::list<Client*>::iterator getPendingPosition() const;
+    
     // Gestion du away (bonus)
     void setAway(bool away, const std::string& message = "");
     bool isAway() const;
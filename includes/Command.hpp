@@ -10,6 +10,13 @@ class Client;
 class Server;
 class Channel;
 
+// Cibles séparées par des virgules acceptées par PRIVMSG et NOTICE (annoncé par TARGMAX dans 005)
+# define MAX_MESSAGE_TARGETS 4
+// Pénalité de flood d'un OPER refusé (20 x FLOOD_PENALTY_MS = 10 s): un essai toutes les quelques secondes au plus
+# define OPER_FAIL_PENALTY 20
+// Canaux au plus par ligne JOIN (annoncé par TARGMAX): borne les réponses retenues par cork
+# define MAX_JOIN_TARGETS 10
+
 // Classe de base abstraite pour toutes les commandes IRC
 class Command 
 {
@@ -18,6 +25,9 @@ protected:
     std::string     _name;      // Nom de la commande (ex: NICK, JOIN, etc.)
     bool            _requiresRegistration; // Si true, le client doit être enregistré pour utiliser la commande
     unsigned int    _minParams;  // Nombre minimum de paramètres
+    unsigned long   _useCount;   // Nombre d'utilisations (STATS m)
+    unsigned long   _useBytes;   // Octets reçus pour cette commande (STATS m)
+    unsigned int    _floodCost;  // Coût facturé au contrôle de flood du client (1 par défaut)
 
 public:
     // Constructeur et destructeur
@@ -28,7 +38,19 @@ public:
     const std::string& getName() const;
     bool requiresRegistration() const;
     unsigned int getMinParams() const;
+    unsigned long getUseCount() const;
+    unsigned long getUseBytes() const;
+    unsigned int getFloodCost() const;
+    
+    // Comptabilise une utilisation de la commande
+    void recordUse(size_t bytes);
     
+protected:
+    // Envoi d'un PRIVMSG ou d'un NOTICE à une liste de cibles (NOTICE ne renvoie pas d'erreur)
+    void deliverMessage(Client* client, const std::string& command, const std::string& targets,
+                        const std::string& text, bool reportErrors);
+    
+public:    
     // Méthode pure virtuelle à implémenter par chaque commande
     virtual void execute(Client* client, const std::vector<std::string>& params) = 0;
 };
@@ -62,6 +84,14 @@ public:
     virtual void execute(Client* client, const std::vector<std::string>& params);
 };
 
+// CAP - Négociation des capacités IRCv3 (LS, LIST, REQ, END)
+class CapCommand : public Command 
+{
+public:
+    CapCommand(Server* server);
+    virtual void execute(Client* client, const std::vector<std::string>& params);
+};
+
 // QUIT - Déconnecte du serveur
 class QuitCommand : public Command 
 {
@@ -77,7 +107,8 @@ public:
     JoinCommand(Server* server);
     virtual void execute(Client* client, const std::vector<std::string>& params);
 private:
-    void sendNames(Client* client, Channel* channel);
+    bool joinChannel(Client* client, const std::string& channelName, const std::string& password);
+    void partAll(Client* client);
 };
 
 // PART - Quitte un canal
@@ -196,6 +227,40 @@ public:
     virtual void execute(Client* client, const std::vector<std::string>& params);
 };
 
+// MOTD - Renvoie le message du jour (bloc pré-rendu, relu sur SIGHUP)
+class MotdCommand : public Command 
+{
+public:
+    MotdCommand(Server* server);
+    virtual void execute(Client* client, const std::vector<std::string>& params);
+};
+
+// ISON - Indique lesquels des pseudos donnés sont connectés
+class IsonCommand : public Command 
+{
+public:
+    IsonCommand(Server* server);
+    virtual void execute(Client* client, const std::vector<std::string>& params);
+};
+
+// USERHOST - Renvoie user@host, statut d'opérateur et absence de chaque pseudo donné
+class UserhostCommand : public Command 
+{
+public:
+    UserhostCommand(Server* server);
+    virtual void execute(Client* client, const std::vector<std::string>& params);
+};
+
+// MONITOR - Surveille la présence d'une liste de pseudos (730/731 à chaque changement)
+class MonitorCommand : public Command 
+{
+public:
+    MonitorCommand(Server* server);
+    virtual void execute(Client* client, const std::vector<std::string>& params);
+private:
+    void sendStatus(Client* client, const std::vector<std::string>& keys);
+};
+
 // OPER - Donne les privilèges d'opérateur à un utilisateur
 class OperCommand : public Command 
 {
@@ -204,6 +269,14 @@ public:
     virtual void execute(Client* client, const std::vector<std::string>& params);
 };
 
+// STATS - Statistiques du serveur
+class StatsCommand : public Command 
+{
+public:
+    StatsCommand(Server* server);
+    virtual void execute(Client* client, const std::vector<std::string>& params);
+};
+
 // Bonus - Commande pour le transfert de fichier
 class FileCommand : public Command 
 {
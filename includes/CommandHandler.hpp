@@ -19,7 +19,12 @@ enum IRCReply {
     RPL_YOURHOST = 002,             // Votre hôte est X, exécutant la version Y
     RPL_CREATED = 003,              // Ce serveur a été créé le...
     RPL_MYINFO = 004,               // <servername> <version> <available user modes> <available channel modes>
+    RPL_STATSLINKINFO = 211,        // <linkname> <sendq> <sent messages> <sent Kbytes> <received messages> <received Kbytes> <time open>
+    RPL_STATSCOMMANDS = 212,        // <command> <count> <byte count> <remote count>
+    RPL_ENDOFSTATS = 219,           // <stats letter> :End of STATS report
     RPL_UMODEIS = 221,              // Mode utilisateur
+    RPL_STATSUPTIME = 242,          // :Server Up %d days %d:%02d:%02d
+    RPL_STATSDEBUG = 249,           // :<informations libres>
     RPL_LUSERCLIENT = 251,          // Il y a <x> utilisateurs et <y> invisibles sur <z> serveurs
     RPL_LUSEROP = 252,              // <integer> :operator(s) online
     RPL_LUSERUNKNOWN = 253,         // <integer> :unknown connection(s)
@@ -76,6 +81,7 @@ enum IRCError {
     ERR_BANNEDFROMCHAN = 474,       // <channel> :Cannot join channel (+b)
     ERR_BADCHANNELKEY = 475,        // <channel> :Cannot join channel (+k)
     ERR_BADCHANMASK = 476,          // <channel> :Bad Channel Mask
+    ERR_NOPRIVILEGES = 481,         // :Permission Denied- You're not an IRC operator
     ERR_CHANOPRIVSNEEDED = 482,     // <channel> :You're not channel operator
     ERR_UMODEUNKNOWNFLAG = 501,     // :Unknown MODE flag
     ERR_USERSDONTMATCH = 502        // :Cannot change mode for other users
@@ -108,6 +114,13 @@ public:
 	bool isValidNickname(const std::string& nickname);
 
 	bool isCommandValid(const std::string& cmdName) const;
+	unsigned int getFloodCost(const std::string& cmdName) const;
+
+	// Parcours des commandes (STATS m)
+	Command* getCommandAfter(const std::string& name) const;
+
+	// Comptabilité mémoire
+	size_t getMemoryUsage() const;
 };
 
 #endif
\ No newline at end of file
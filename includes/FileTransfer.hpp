@@ -57,6 +57,9 @@ public:
     
     // Méthodes utilitaires
     void cleanupCompletedTransfers();
+    
+    // Comptabilité mémoire
+    size_t getMemoryUsage() const;
 };
 
 #endif
\ No newline at end of file
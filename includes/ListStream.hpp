@@ -0,0 +1,51 @@
+#ifndef LIST_STREAM_HPP
+# define LIST_STREAM_HPP
+
+# include <string>        // Pour les chaînes de caractères
+# include <vector>        // Pour les masques et les noms demandés
+# include <ctime>         // Pour les filtres de date
+
+# include "ReplyStream.hpp"
+
+class Server;
+class Client;
+class Channel;
+
+// Nombre de canaux examinés au plus par tour, même si aucun ne passe les filtres
+# define LIST_SCAN_PER_TURN 512
+
+// Filtres ELIST évalués pendant le parcours (0 = pas de borne)
+struct ListFilter
+{
+    unsigned int    minUsers;       // >n: plus de n membres (borne exclue)
+    unsigned int    maxUsers;       // <n: moins de n membres (borne exclue)
+    time_t          createdAfter;   // C<n: créé il y a moins de n minutes
+    time_t          createdBefore;  // C>n: créé il y a plus de n minutes
+    time_t          topicAfter;     // T<n: sujet changé il y a moins de n minutes
+    time_t          topicBefore;    // T>n: sujet changé il y a plus de n minutes
+    std::vector<std::string> masks;     // Le nom doit correspondre à l'un de ces masques
+    std::vector<std::string> excludes;  // !masque: le nom ne doit correspondre à aucun
+};
+
+// LIST - Parcours reprenable de la table des canaux, au rythme où la file d'envoi se vide
+class ListStream : public ReplyStream
+{
+private:
+    Server*         _server;        // Pointeur vers le serveur
+    ListFilter      _filter;        // Filtres de la requête
+    std::vector<std::string> _names; // Noms exacts demandés (parcours direct au lieu de la table)
+    size_t          _nextName;      // Prochain nom exact à chercher
+    std::string     _cursor;        // Dernier canal examiné (nom en minuscules)
+    bool            _started;       // RPL_LISTSTART déjà envoyé
+
+    bool matches(Client* client, Channel* channel) const;
+    Channel* next();
+
+public:
+    ListStream(Server* server, const std::string& query);
+    virtual bool pump(Client* client, unsigned int& budget);
+
+    static bool parseFilter(const std::string& token, ListFilter& filter, time_t now);
+};
+
+#endif
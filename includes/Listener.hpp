@@ -0,0 +1,110 @@
+#ifndef LISTENER_HPP
+# define LISTENER_HPP
+
+# include <string>       // Pour l'adresse et la classe de connexion
+# include <sys/socket.h> // Pour les fonctions socket
+
+// Fichier des ports d'écoute supplémentaires (même principe que bot_config.txt)
+# define LISTENER_CONFIG_FILE "listen_config.txt"
+// Nombre maximum de sockets en écoute
+# define MAX_LISTENERS 8
+// Classe des connexions reçues sur le port de la ligne de commande
+# define LISTENER_DEFAULT_CLASS "default"
+// Préfixe d'une adresse de socket Unix dans listen_config.txt (unix:/chemin)
+# define LISTENER_UNIX_PREFIX "unix:"
+// Permissions par défaut du fichier de socket Unix
+# define LISTENER_UNIX_MODE 0660
+// Profil de réglage des sockets du port de la ligne de commande (utilisateurs humains)
+# define LISTENER_DEFAULT_PROFILE "lowlatency"
+
+// Options appliquées à chaque socket accepté (0 = valeur du noyau conservée)
+struct SocketProfile
+{
+    std::string     name;           // Nom du profil de base
+    bool            noDelay;        // TCP_NODELAY: pas d'agrégation de Nagle
+    int             sndBuf;         // SO_SNDBUF (octets)
+    int             rcvBuf;         // SO_RCVBUF (octets)
+    int             keepIdle;       // TCP_KEEPIDLE (s), active SO_KEEPALIVE si non nul
+    int             keepInterval;   // TCP_KEEPINTVL (s)
+    int             keepCount;      // TCP_KEEPCNT (sondes)
+    int             userTimeout;    // TCP_USER_TIMEOUT (ms) avant d'abandonner des données non acquittées
+    int             notSentLowat;   // TCP_NOTSENT_LOWAT (octets non envoyés gardés par le noyau)
+};
+
+// Compteurs de la boucle d'acceptation d'un socket en écoute
+struct AcceptStats
+{
+    unsigned long   accepted;           // Connexions acceptées
+    unsigned long   bursts;             // Réveils ayant accepté plus d'une connexion
+    unsigned long   capped;             // Réveils arrêtés par ACCEPT_PER_TURN (reste en file)
+    unsigned long   overflows;          // Réveils où la file du noyau était pleine (SYN perdus)
+    unsigned long   maxQueue;           // Plus longue file d'attente observée
+    unsigned long   refused;            // Fermées aussitôt (port plein ou contrôle d'admission)
+};
+
+// Socket en écoute sur une adresse et un port, avec ses propres options
+// et la classe attribuée aux connexions qu'il reçoit
+class Listener
+{
+private:
+    std::string     _address;           // Adresse d'écoute ("::" = double pile IPv6/IPv4) ou chemin du socket Unix
+    int             _port;              // Port d'écoute (0 pour un socket Unix)
+    bool            _unix;              // Socket AF_UNIX: pairs locaux identifiés par SO_PEERCRED
+    unsigned int    _mode;              // Permissions du fichier de socket Unix
+    bool            _trusted;           // Connexions exemptées du contrôle de flood
+    int             _backlog;           // File d'attente demandée à listen
+    bool            _reusePort;         // SO_REUSEPORT (plusieurs processus sur le même port)
+    std::string     _className;         // Classe des connexions reçues
+    unsigned int    _maxConnections;    // Connexions simultanées permises (0 = limite globale seule)
+    int             _fd;                // Socket en écoute (-1 si fermé)
+    unsigned int    _connections;       // Connexions ouvertes reçues par ce socket
+    AcceptStats     _stats;             // Rafales et débordements de la file
+    SocketProfile   _profile;           // Réglages appliqués aux sockets acceptés
+
+    Listener(const Listener&);
+    Listener& operator=(const Listener&);
+
+public:
+    // Constructeur et destructeur
+    Listener(const std::string& address, int port, int backlog, bool reusePort,
+             const std::string& className, unsigned int maxConnections);
+    ~Listener();
+
+    // Options
+    void setUnix(unsigned int mode);
+    void setTrusted(bool trusted);
+    bool setProfile(const std::string& name);
+    bool setSocketOption(const std::string& option);
+    const SocketProfile& getProfile() const;
+
+    // Ouverture et fermeture du socket
+    void open(int somaxconn);
+    void close();
+    static std::string peerIdentity(int clientFd);
+
+    // Connexions reçues
+    bool isFull() const;
+    void addConnection();
+    void removeConnection();
+    void sampleQueue();
+    void tune(int clientFd) const;
+    static std::string describeSocket(int fd, bool tcp);
+    AcceptStats& getStats();
+    const AcceptStats& getStats() const;
+
+    // Getters
+    int getFd() const;
+    int getPort() const;
+    int getBacklog() const;
+    bool getReusePort() const;
+    bool isUnix() const;
+    bool isTrusted() const;
+    const std::string& getClassName() const;
+    unsigned int getMaxConnections() const;
+    unsigned int getConnections() const;
+
+    // Conversion en string pour l'affichage ([::]:6667, 127.0.0.1:6697, unix:/chemin)
+    std::string toString() const;
+};
+
+#endif
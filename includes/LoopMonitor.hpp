@@ -0,0 +1,67 @@
+#ifndef LOOP_MONITOR_HPP
+# define LOOP_MONITOR_HPP
+
+# include <string>       // Pour les chaînes de caractères
+# include <stdint.h>     // Pour uint64_t
+
+// Budget d'une itération de la boucle d'événements (en microsecondes)
+# define LOOP_BUDGET_US 50000
+// Facteur de lissage de la moyenne glissante (nouvelle valeur pondérée à 1/N)
+# define LOOP_SMOOTHING 8
+// Intervalle minimum entre deux avertissements de dépassement (en microsecondes)
+# define LOOP_WARN_INTERVAL_US 1000000
+
+// Mesure le temps passé dans chaque itération de Server::start
+class LoopMonitor
+{
+private:
+    uint64_t        _pollStart;         // Début de l'attente dans poll
+    uint64_t        _busyStart;         // Retour de poll, début du traitement
+    int             _readyFds;          // Descripteurs prêts pour l'itération en cours
+    unsigned int    _iterationLines;    // Lignes traitées pendant l'itération en cours
+    size_t          _iterationBytes;    // Octets envoyés pendant l'itération en cours
+
+    unsigned long   _iterations;        // Nombre total d'itérations
+    unsigned long   _slowIterations;    // Itérations ayant dépassé le budget
+    uint64_t        _totalBusy;         // Temps total passé à traiter (µs)
+    uint64_t        _totalIdle;         // Temps total passé dans poll (µs)
+    uint64_t        _maxBusy;           // Itération la plus longue (µs)
+    uint64_t        _lagEstimate;       // Moyenne glissante du temps de traitement (µs)
+    unsigned int    _loadEstimate;      // Moyenne glissante de la charge (pour mille)
+    unsigned long   _totalReadyFds;     // Somme des descripteurs prêts
+    int             _maxReadyFds;       // Plus grand nombre de descripteurs prêts
+    unsigned long   _totalLines;        // Lignes traitées depuis le démarrage
+    unsigned long   _totalBytesFlushed; // Octets envoyés depuis le démarrage
+    uint64_t        _lastWarning;       // Dernier avertissement émis
+    unsigned long   _suppressedWarnings; // Avertissements non affichés depuis le dernier
+
+public:
+    // Constructeur et destructeur
+    LoopMonitor();
+    ~LoopMonitor();
+
+    // Points de mesure appelés par la boucle d'événements
+    void pollStarted();
+    void pollReturned(int readyFds);
+    void iterationDone();
+
+    // Compteurs alimentés pendant le traitement
+    void addLines(unsigned int count);
+    void addBytesFlushed(size_t bytes);
+
+    // Getters
+    unsigned long getIterations() const;
+    unsigned long getSlowIterations() const;
+    uint64_t getLagEstimate() const;
+    uint64_t getMaxBusy() const;
+    unsigned int getLoadEstimate() const;
+    unsigned long getTotalReadyFds() const;
+    int getMaxReadyFds() const;
+    unsigned long getTotalLines() const;
+    unsigned long getTotalBytesFlushed() const;
+
+    // Conversion en string pour l'affichage
+    std::string toString() const;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef MEMORY_REPORT_HPP
+# define MEMORY_REPORT_HPP
+
+# include <string>        // Pour les chaînes de caractères
+# include <vector>        // Pour les plus gros consommateurs
+
+class Server;
+class Client;
+class Channel;
+
+// Nombre de plus gros consommateurs conservés par catégorie
+# define MEMORY_TOP_N 5
+// Surcoût estimé d'un nœud de std::map / std::set (couleur, parent, fils gauche et droit)
+# define MEMORY_TREE_NODE_OVERHEAD (4 * sizeof(void*))
+
+// Un consommateur de mémoire (client ou canal) dans un classement
+struct MemoryConsumer
+{
+    std::string     name;       // Pseudo ou nom du canal
+    size_t          bytes;      // Octets attribués
+    size_t          count;      // Information complémentaire (messages en file, membres)
+};
+
+// Agrégation de la mémoire par sous-système, alimentée client par client et canal par canal
+class MemoryReport
+{
+private:
+    unsigned long   _clients;           // Nombre de clients
+    size_t          _clientBytes;       // Structures et chaînes des clients
+    size_t          _recvQBytes;        // Buffers de réception
+    size_t          _sendQBytes;        // Files d'envoi
+    unsigned long   _channels;          // Nombre de canaux
+    size_t          _channelBytes;      // Structures, noms et mots de passe des canaux
+    unsigned long   _memberships;       // Nombre d'appartenances à des canaux
+    size_t          _memberBytes;       // Tables des membres
+    unsigned long   _invites;           // Nombre d'invitations en attente
+    size_t          _inviteBytes;       // Listes d'invitations
+    size_t          _topicBytes;        // Sujets des canaux
+    size_t          _fileTransferBytes; // Transferts de fichiers
+    size_t          _botBytes;          // État du bot
+    size_t          _serverBytes;       // Tables du serveur et commandes
+    std::vector<MemoryConsumer> _topSendQ;   // Plus grosses files d'envoi
+    std::vector<MemoryConsumer> _topChannels; // Plus gros canaux
+
+    static void insertTop(std::vector<MemoryConsumer>& top, const MemoryConsumer& consumer);
+
+public:
+    // Constructeur et destructeur
+    MemoryReport();
+    ~MemoryReport();
+
+    // Comptabilisation
+    void addClient(const Client* client);
+    void addChannel(const Channel* channel);
+    void addServer(const Server* server);
+
+    // Résultats
+    size_t getTotal() const;
+    std::vector<std::string> toLines() const;
+};
+
+#endif
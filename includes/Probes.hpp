@@ -0,0 +1,50 @@
+#ifndef PROBES_HPP
+# define PROBES_HPP
+
+// Sondes statiques USDT (provider "ft_irc") pour perf et bpftrace.
+// Compilées avec "make USDT=1" (nécessite sys/sdt.h): chaque sonde est une
+// instruction nop tant qu'aucun outil n'y est attaché. Sans USDT=1 elles
+// disparaissent entièrement et leurs arguments ne sont pas évalués.
+//
+//   client__accept(fd)                       nouvelle connexion acceptée
+//   client__remove(fd, registered)           connexion fermée
+//   line__received(fd, bytes)                ligne extraite du buffer de réception
+//   command__dispatch(name, fd)              début d'exécution d'une commande
+//   command__done(name, fd, duration_us)     fin d'exécution d'une commande
+//   channel__broadcast(channel, fanout)      diffusion à un canal
+//   peers__broadcast(fd, fanout)             QUIT/NICK aux membres des canaux communs, une copie chacun
+//   send__partial(fd, sent, length)          send n'a écrit qu'une partie du message
+//   send__eagain(fd, sendq)                  socket plein, message gardé en SendQ
+//   sendq__overflow(fd, sendq, limit)        voie de la SendQ au-delà de sa limite, client déconnecté
+//
+// Exemple: bpftrace -e 'usdt:./ircserv:ft_irc:command__done { @[str(arg0)] = hist(arg2); }'
+
+// Chaque sonde a un sémaphore que perf/bpftrace incrémentent en s'y attachant:
+// IRC_PROBE_ENABLED permet de sauter un argument coûteux (horloge de command__done)
+// tant que personne n'écoute. Les sémaphores sont définis une seule fois, dans Server.cpp.
+# define IRC_PROBE_LIST(X) X(client__accept) X(client__remove) X(line__received) \
+    X(command__dispatch) X(command__done) X(channel__broadcast) X(peers__broadcast) \
+    X(send__partial) X(send__eagain) X(sendq__overflow)
+
+# ifdef FT_IRC_USDT
+#  define _SDT_HAS_SEMAPHORES 1
+#  include <sys/sdt.h>
+#  include "Utils.hpp"
+#  define IRC_PROBE_DECLARE(name) extern unsigned short ft_irc_##name##_semaphore;
+#  define IRC_PROBE_DEFINE(name) unsigned short ft_irc_##name##_semaphore __attribute__((section(".probes")));
+IRC_PROBE_LIST(IRC_PROBE_DECLARE)
+#  define IRC_PROBE_ENABLED(name) (ft_irc_##name##_semaphore != 0)
+#  define IRC_PROBE_CLOCK(name) (IRC_PROBE_ENABLED(name) ? Utils::getMonotonicMicros() : 0)
+#  define IRC_PROBE1(name, a1) DTRACE_PROBE1(ft_irc, name, a1)
+#  define IRC_PROBE2(name, a1, a2) DTRACE_PROBE2(ft_irc, name, a1, a2)
+#  define IRC_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(ft_irc, name, a1, a2, a3)
+# else
+// sizeof n'évalue pas ses arguments mais les marque comme utilisés
+#  define IRC_PROBE_ENABLED(name) 0
+#  define IRC_PROBE_CLOCK(name) 0
+#  define IRC_PROBE1(name, a1) ((void)sizeof(a1))
+#  define IRC_PROBE2(name, a1, a2) ((void)sizeof(a1), (void)sizeof(a2))
+#  define IRC_PROBE3(name, a1, a2, a3) ((void)sizeof(a1), (void)sizeof(a2), (void)sizeof(a3))
+# endif
+
+#endif
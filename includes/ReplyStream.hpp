@@ -0,0 +1,23 @@
+#ifndef REPLY_STREAM_HPP
+# define REPLY_STREAM_HPP
+
+class Client;
+
+// Nombre maximum de lignes qu'un flux peut émettre par tour de boucle
+# define STREAM_LINES_PER_TURN 64
+// Taille de la SendQ au-dessus de laquelle on attend qu'elle se vide avant de continuer
+# define STREAM_SENDQ_LOWAT 8192
+
+// Réponse longue produite par morceaux (STATS, ...), reprise à chaque tour de boucle
+// tant que la file d'envoi du client le permet
+class ReplyStream
+{
+public:
+    virtual ~ReplyStream();
+
+    // Émet des lignes en décrémentant budget pour chacune
+    // return true quand la réponse est terminée
+    virtual bool pump(Client* client, unsigned int& budget) = 0;
+};
+
+#endif
@@ -5,6 +5,9 @@
 # include <string>       // Pour manipuler les chaînes de caractères
 # include <map>          // Pour stocker les clients et les canaux
 # include <vector>       // Pour stocker les collections de données
+# include <set>          // Pour les clients ayant des réponses en cours
+# include <list>         // Pour les connexions non enregistrées (ordre d'arrivée)
+# include <deque>        // Pour la file des clients ayant des lignes en attente
 # include <ctime>        // Pour horodater les messages et les événements
 # include <cstring>      // Pour les fonctions de manipulation de chaînes C
 # include <cerrno>       // Pour les codes d'erreur
@@ -22,11 +25,37 @@
 # include "CommandHandler.hpp"
 # include "FileTransfer.hpp" // Pour les bonus - transfert de fichiers
 # include "Bot.hpp"          // Pour les bonus - bot IRC
+# include "LoopMonitor.hpp"  // Pour mesurer la charge de la boucle d'événements
+# include "MemoryReport.hpp" // Pour la comptabilité mémoire par sous-système
+# include "Tracer.hpp"       // Pour le traçage échantillonné des messages
+# include "TimerWheel.hpp"   // Pour les délais (keepalive, enregistrement)
+# include "Admission.hpp"    // Pour le contrôle d'admission à l'acceptation
+# include "Listener.hpp"     // Pour les sockets en écoute
+# include "Welcome.hpp"      // Pour la rafale d'enregistrement et le MOTD pré-rendus
 
 // Nombre maximum de clients que le serveur peut gérer
 # define MAX_CLIENTS 100
 // Taille maximum du buffer pour la réception des données
 # define BUFFER_SIZE 1024
+// Lignes et temps (en microsecondes) accordés à un client par tour de boucle
+# define LINES_PER_TURN 8
+# define CLIENT_TURN_US 2000
+// File d'attente de listen par défaut (bornée par net.core.somaxconn)
+# define LISTEN_BACKLOG_DEFAULT 511
+# define SOMAXCONN_PATH "/proc/sys/net/core/somaxconn"
+// Connexions acceptées au plus par réveil du socket serveur, pour ne pas affamer les clients
+# define ACCEPT_PER_TURN 64
+// Comptes OPER, une ligne "<nom> <mot de passe>" (même principe que bot_config.txt)
+# define OPER_CONFIG_FILE "oper_config.txt"
+
+// Compteurs des connexions qui n'ont pas terminé leur enregistrement
+struct RegistrationStats
+{
+    unsigned long   timedOutConnecting; // Délai dépassé sans PASS valide
+    unsigned long   timedOutPassword;   // Délai dépassé après PASS, sans NICK/USER
+    unsigned long   reaped;             // Fermées pour libérer une place (pression sur les fd)
+    unsigned long   bufferExceeded;     // Buffer de réception trop grand avant l'enregistrement
+};
 
 class Client;
 class Channel;
@@ -37,26 +66,53 @@ class Bot;
 class Server
 {
 private:
-	int                         _serverSocket;       // Socket principal du serveur
-	int                         _port;               // Port d'écoute du serveur
+	int                         _port;               // Port d'écoute de la ligne de commande
+	int                         _backlog;            // File d'attente par défaut des sockets en écoute
 	std::string                 _password;           // Mot de passe pour se connecter au serveur
 	std::string                 _serverName;         // Nom du serveur IRC
 	std::string                 _creationDate;       // Date de création du serveur
+	time_t                      _startTime;          // Heure de démarrage (uptime)
 	std::map<int, Client*>      _clients;            // Map des clients connectés (fd → Client)
+	std::map<std::string, Client*> _nicknames;       // Index des pseudos (minuscules → Client)
+	std::map<std::string, std::vector<Client*> > _monitors; // Index inverse MONITOR (pseudo en minuscules → observateurs)
+	unsigned long               _fanoutGeneration;   // Numéro du dernier événement diffusé aux membres communs
 	std::map<std::string, Channel*> _channels;       // Map des canaux existants (nom → Channel)
-	struct pollfd               _fds[MAX_CLIENTS+1]; // Tableau pour poll (socket serveur + clients)
+	std::vector<Listener*>      _listeners;          // Sockets en écoute (en tête de _fds)
+	struct pollfd               _fds[MAX_CLIENTS + MAX_LISTENERS]; // Tableau pour poll (sockets en écoute + clients)
 	int                         _nfds;               // Nombre de descripteurs suivis par poll
 	CommandHandler*             _commandHandler;     // Gestionnaire de commandes
 	bool                        _running;            // État d'exécution du serveur
+	bool                        _streamsReady;       // Un flux peut avancer sans attendre poll
+	std::set<int>               _streamingFds;       // Clients ayant des réponses longues en cours
+	std::set<int>               _closingFds;         // Clients déconnectés à fermer en fin de tour
+	std::list<Client*>          _pendingClients;     // Connexions non enregistrées, plus ancienne en tête
+	std::deque<int>             _runQueue;           // Clients ayant encore des lignes complètes (tourniquet)
+	RegistrationStats           _registrationStats;  // Échecs d'enregistrement par étape
+	LoopMonitor                 _loopMonitor;        // Mesures de la boucle d'événements
+	Tracer                      _tracer;             // Traçage échantillonné (IRC_TRACE_FILE)
+	TimerWheel                  _timerWheel;         // Timers des clients
+	Admission                   _admission;          // Règles par préfixe, limite par adresse, débit d'acceptation
+	std::map<std::string, std::string> _operators;   // Comptes OPER (nom → mot de passe)
+	WelcomeBurst                _welcome;            // Rafale 001-376 et MOTD pré-rendus
+	unsigned int                _operatorCount;      // Clients opérateurs (252)
+	volatile sig_atomic_t       _motdReloadPending;  // SIGHUP reçu (écrit par le gestionnaire de signal): relire le MOTD
 
 	// Bonus
 	FileTransfer*               _fileTransfer;       // Gestionnaire de transfert de fichiers
 	Bot*                        _bot;                // Bot IRC
 
 	// Méthodes privées utilisées en interne par le serveur
-	void setupServerSocket();                        // Configuration du socket serveur
-	void acceptNewConnection();                      // Acceptation d'une nouvelle connexion
-	void handleClientMessage(int clientFd);          // Traitement des messages des clients
+	void setupListeners();                           // Ouverture des sockets en écoute
+	void loadOperators(const std::string& path);     // Lecture des comptes OPER
+	void acceptNewConnection(Listener* listener);    // Acceptation des connexions en attente
+	void addConnection(int clientFd, const IpAddress* address, Listener* listener); // Enregistrement d'une connexion acceptée
+	void handleClientMessage(int clientFd);          // Lecture des messages des clients
+	void refreshPollEvents();                        // Demander POLLOUT pour les SendQ non vides
+	void pumpStreams();                              // Faire avancer les réponses longues
+	void reapClients();                              // Fermer les clients marqués déconnectés
+	bool reapOldestPending();                        // Fermer la plus ancienne connexion non enregistrée
+	void scheduleRun(Client* client);                // Client à reprendre au prochain tour
+	void runClients(size_t count);                   // Reprendre les count premiers clients de la file, chacun à son tour
 
 public:
 	// Constructeur et destructeur
@@ -72,12 +128,48 @@ public:
 	std::string getPassword() const;
 	std::string getServerName() const;
 	std::string getCreationDate() const;
+	time_t getStartTime() const;
+	LoopMonitor& getLoopMonitor();
+	const LoopMonitor& getLoopMonitor() const;
+	Tracer& getTracer();
+	TimerWheel& getTimerWheel();
+	const Admission& getAdmission() const;
+	const WelcomeBurst& getWelcome() const;
+	void requestMotdReload();                        // Appelé par le gestionnaire de SIGHUP
+	CommandHandler* getCommandHandler() const;
+	FileTransfer* getFileTransfer() const;
+	Bot* getBot() const;
+
+	// Comptabilité mémoire
+	size_t getMemoryUsage() const;                   // Tables propres au serveur
+	void collectMemoryReport(MemoryReport& report) const; // Rapport complet (parcours immédiat)
 
 	// Gestion des clients
 	Client* getClient(int fd) const;
 	Client* getClientByNickname(const std::string& nickname) const;
+	void renameClient(Client* client, const std::string& nickname); // Changement de pseudo (index à jour)
 	void broadcast(const std::string& message, int excludeFd = -1);
+	bool checkOperator(const std::string& name, const std::string& password) const; // Identifiants de OPER
+	void broadcastToPeers(Client* client, const std::string& message); // Une copie par membre d'un canal commun
+	void addMonitor(Client* watcher, const std::string& key);    // MONITOR + (pseudo en minuscules)
+	void removeMonitor(Client* watcher, const std::string& key); // MONITOR -
+	void clearMonitors(Client* watcher);             // MONITOR C et déconnexion de l'observateur
+	void notifyMonitors(const std::string& nickname, Client* online); // 730 (online) ou 731 (NULL) aux observateurs
 	unsigned int getClientCount() const;             // Nombre de clients connectés
+	unsigned int getOperatorCount() const;           // Nombre d'opérateurs connectés
+	void updateOperatorCount(bool op);               // Client devenu (true) ou n'étant plus (false) opérateur
+	Client* getClientAfter(int fd) const;            // Parcours des clients par fd croissant
+	void scheduleStreams(Client* client);            // Client ayant des réponses longues à émettre
+	void scheduleRemoval(int fd);                    // Client à fermer à la fin du tour de boucle
+	void processClientBuffer(Client* client);        // Exécution des lignes complètes reçues
+	void removePendingClient(Client* client);        // Client enregistré ou déconnecté
+	unsigned int getPendingCount() const;            // Connexions non enregistrées
+	unsigned int getRunQueueLength() const;          // Clients en attente de leur tour
+	void recordRegistrationTimeout(bool passwordAccepted); // Délai dépassé avant/après PASS
+	const RegistrationStats& getRegistrationStats() const;
+	AcceptStats getAcceptStats() const;              // Totaux de tous les sockets en écoute
+	int getListenBacklog() const;                    // File d'attente par défaut
+	const std::vector<Listener*>& getListeners() const;
 
 	// Gestion des canaux
 	Channel* getChannel(const std::string& name) const;
@@ -85,6 +177,7 @@ public:
 	void removeChannel(const std::string& name);
 	std::map<std::string, Channel*> getChannels() const;
 	unsigned int getChannelCount() const;            // Nombre de canaux existants
+	Channel* getChannelAfter(const std::string& key) const; // Parcours des canaux par nom (minuscules)
 
 	// Bonus - Transfert de fichiers
 	void initFileTransfer();
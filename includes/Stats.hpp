@@ -0,0 +1,58 @@
+#ifndef STATS_HPP
+# define STATS_HPP
+
+# include <string>        // Pour les chaînes de caractères
+# include <vector>        // Pour les lignes du rapport
+
+# include "ReplyStream.hpp"
+# include "MemoryReport.hpp"
+
+class Server;
+class Client;
+
+// Nombre d'entrées parcourues par tour pour les statistiques agrégées (STATS z)
+# define STATS_ENTRIES_PER_TURN 256
+
+// STATS m - Utilisation des commandes, parcourues par nom
+class StatsCommandsStream : public ReplyStream
+{
+private:
+    Server*         _server;    // Pointeur vers le serveur
+    std::string     _cursor;    // Dernière commande émise
+
+public:
+    StatsCommandsStream(Server* server);
+    virtual bool pump(Client* client, unsigned int& budget);
+};
+
+// STATS l - Informations sur chaque connexion, parcourues par fd
+class StatsLinksStream : public ReplyStream
+{
+private:
+    Server*         _server;    // Pointeur vers le serveur
+    int             _cursor;    // Dernier fd émis
+
+public:
+    StatsLinksStream(Server* server);
+    virtual bool pump(Client* client, unsigned int& budget);
+};
+
+// STATS z - Mémoire par sous-système, accumulée sur plusieurs tours
+class StatsMemoryStream : public ReplyStream
+{
+private:
+    Server*         _server;        // Pointeur vers le serveur
+    int             _clientCursor;  // Dernier client comptabilisé
+    std::string     _channelCursor; // Dernier canal comptabilisé
+    bool            _clientsDone;   // Tous les clients ont été parcourus
+    bool            _channelsDone;  // Tous les canaux ont été parcourus
+    MemoryReport    _report;        // Totaux accumulés
+    std::vector<std::string> _lines; // Lignes du rapport une fois le parcours terminé
+    size_t          _nextLine;      // Prochaine ligne à émettre
+
+public:
+    StatsMemoryStream(Server* server);
+    virtual bool pump(Client* client, unsigned int& budget);
+};
+
+#endif
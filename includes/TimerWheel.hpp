@@ -0,0 +1,76 @@
+#ifndef TIMER_WHEEL_HPP
+# define TIMER_WHEEL_HPP
+
+# include <stdint.h>     // Pour uint64_t
+
+// Durée d'un tick de la roue (en millisecondes)
+# define TIMER_TICK_MS 100
+// Nombre de niveaux de la roue et de cases par niveau (2^TIMER_SLOT_BITS)
+# define TIMER_LEVELS 4
+# define TIMER_SLOT_BITS 6
+# define TIMER_SLOTS (1 << TIMER_SLOT_BITS)
+# define TIMER_SLOT_MASK (TIMER_SLOTS - 1)
+
+class TimerWheel;
+
+// Maillon d'une liste doublement chaînée circulaire (case de la roue ou timer)
+struct TimerLink
+{
+    TimerLink*      prev;
+    TimerLink*      next;
+};
+
+// Timer intrusif: l'objet qui en hérite est chaîné directement dans la roue,
+// sans allocation à l'armement ni à l'annulation
+class Timer : private TimerLink
+{
+private:
+    TimerWheel*     _wheel;     // Roue dans laquelle le timer est armé (NULL sinon)
+    uint64_t        _expires;   // Tick d'échéance
+
+    friend class TimerWheel;
+
+    Timer(const Timer&);
+    Timer& operator=(const Timer&);
+
+public:
+    Timer();
+    virtual ~Timer();
+
+    bool isPending() const;
+
+    // Appelé par la roue à l'échéance (le timer est déjà désarmé)
+    virtual void expire() = 0;
+};
+
+// Roue de timers hiérarchique (4 niveaux de 64 cases): armement et annulation en O(1),
+// les timers lointains descendent d'un niveau quand la roue inférieure fait un tour
+class TimerWheel
+{
+private:
+    TimerLink       _slots[TIMER_LEVELS][TIMER_SLOTS]; // Têtes des listes de chaque case
+    uint64_t        _current;   // Prochain tick à traiter
+    unsigned long   _pending;   // Nombre de timers armés
+
+    void link(Timer* timer);
+    void unlink(Timer* timer);
+    void cascade(int level);
+
+    TimerWheel(const TimerWheel&);
+    TimerWheel& operator=(const TimerWheel&);
+
+public:
+    TimerWheel();
+    ~TimerWheel();
+
+    // Armement et annulation
+    void schedule(Timer* timer, uint64_t delayMs);
+    void cancel(Timer* timer);
+
+    // Boucle d'événements
+    void advance(uint64_t nowMs);
+    int nextTimeout(uint64_t nowMs) const;
+    unsigned long getPending() const;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef TRACER_HPP
+# define TRACER_HPP
+
+# include <string>       // Pour le chemin du fichier de trace
+# include <vector>       // Pour le tampon d'enregistrements
+# include <stdint.h>     // Pour les entiers de taille fixe du format binaire
+
+// En-tête du fichier de trace (8 octets) suivi d'enregistrements TraceRecord
+# define TRACE_MAGIC "IRCTRC01"
+// Taux d'échantillonnage par défaut: une ligne sur N
+# define TRACE_DEFAULT_SAMPLE 100
+// Nombre d'enregistrements gardés en mémoire avant écriture
+# define TRACE_BUFFER_RECORDS 512
+
+// Étapes du cycle de vie d'une ligne tracée
+enum TraceEvent
+{
+    TRACE_RECV = 1,      // Données reçues par recv (ligne complétée)
+    TRACE_PARSE = 2,     // Ligne extraite du buffer de réception
+    TRACE_EXECUTE = 3,   // Début de l'exécution de la commande
+    TRACE_DONE = 4,      // Fin de l'exécution de la commande
+    TRACE_ENQUEUE = 5,   // Message ajouté à la file d'envoi d'un client
+    TRACE_SEND = 6       // Message entièrement écrit sur le socket d'un client
+};
+
+// Enregistrement binaire (24 octets, ordre des octets de la machine)
+struct TraceRecord
+{
+    uint64_t        timestamp;  // Horloge monotone en microsecondes
+    uint32_t        traceId;    // Identifiant de la ligne tracée
+    int32_t         fd;         // Client concerné (émetteur ou destinataire)
+    uint16_t        event;      // TraceEvent
+    uint16_t        reserved;   // Alignement
+    uint32_t        bytes;      // Taille de la ligne ou du message
+};
+
+// Traçage échantillonné du parcours d'une ligne, de recv jusqu'au send des réponses
+class Tracer
+{
+private:
+    int             _fd;            // Fichier de trace (-1 si désactivé)
+    unsigned int    _sampleRate;    // Une ligne tracée sur _sampleRate
+    unsigned long   _lineCounter;   // Lignes vues depuis le démarrage
+    uint32_t        _nextId;        // Prochain identifiant de trace
+    uint32_t        _current;       // Trace de la ligne en cours d'exécution (0 si aucune)
+    std::vector<TraceRecord> _buffer; // Enregistrements en attente d'écriture
+
+    void flush();
+
+public:
+    // Constructeur et destructeur
+    Tracer();
+    ~Tracer();
+
+    // Activation
+    bool open(const std::string& path, unsigned int sampleRate);
+    bool isEnabled() const;
+
+    // Cycle de vie d'une ligne
+    uint32_t beginLine(int fd, uint64_t recvTime, size_t bytes);
+    void endLine();
+    uint32_t current() const;
+    void record(uint32_t traceId, TraceEvent event, int fd, size_t bytes);
+};
+
+#endif
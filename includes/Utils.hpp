@@ -4,6 +4,7 @@
 # include <string>       // Pour les chaînes de caractères
 # include <vector>       // Pour les collections
 # include <sstream>      // Pour les flux de chaînes
+# include <stdint.h>     // Pour uint64_t
 
 // Espace de noms pour les fonctions utilitaires
 namespace Utils 
@@ -17,10 +18,12 @@ namespace Utils
     // Fonctions pour les conversions
     int                     toInt(const std::string& str);
     std::string             toString(int value);
+    std::string             sizeToString(size_t value);
     
     // Fonctions pour la gestion du temps
     std::string             getCurrentTime();
     std::string             formatTime(time_t time);
+    uint64_t                getMonotonicMicros();
     
     // Fonction de log
     void                    logMessage(const std::string& message, bool isError = false);
@@ -29,6 +32,10 @@ namespace Utils
     bool                    isValidChannelName(const std::string& name);
     bool                    isValidNickname(const std::string& nickname);
     
+    // Fonctions pour les masques (jokers * et ?)
+    bool                    matchMask(const std::string& mask, const std::string& str);
+    bool                    hasWildcards(const std::string& mask);
+    
     // Fonctions pour générer des messages IRC
     std::string             formatIRCMessage(const std::string& prefix, const std::string& command, const std::vector<std::string>& params);
     std::vector<std::string> parseIRCMessage(const std::string& message, std::string& prefix, std::string& command);
@@ -45,6 +52,9 @@ namespace Utils
     std::string             getFileExtension(const std::string& filename);
     size_t                  getFileSize(const std::string& path);
     
+    // Fonctions pour la comptabilité mémoire
+    size_t                  stringMemory(const std::string& str);
+    
     // Fonctions pour sécuriser les entrées
     std::string             sanitizeInput(const std::string& input);
 }
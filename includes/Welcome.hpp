@@ -0,0 +1,78 @@
+#ifndef WELCOME_HPP
+# define WELCOME_HPP
+
+# include <string>        // Pour les chaînes de caractères
+# include <vector>        // Pour les segments et les lignes du MOTD
+
+class Client;
+
+// Fichier du message du jour (même principe que bot_config.txt), relu sur SIGHUP
+# define MOTD_FILE "ircd.motd"
+// Lignes du MOTD gardées au plus (la rafale doit tenir dans la SendQ prioritaire)
+# define MOTD_MAX_LINES 100
+// Longueur maximum du texte d'une ligne 372
+# define MOTD_LINE_MAX 400
+// Jetons au plus par ligne 005
+# define ISUPPORT_PER_LINE 13
+// Modes de canal par type ISUPPORT (A: listes, B: clé, C: limite, D: drapeaux) et préfixes de statut
+# define ISUPPORT_CHANMODES ",k,l,ipst"
+# define ISUPPORT_PREFIX "(ov)@+"
+
+// Valeur propre au client insérée après le texte fixe d'un segment
+enum WelcomeField
+{
+    WELCOME_NONE,       // Texte seul (dernier segment)
+    WELCOME_NICK,       // Pseudo du client
+    WELCOME_MASK,       // nick!user@host
+    WELCOME_USERS,      // Clients connectés
+    WELCOME_OPERS,      // Opérateurs connectés
+    WELCOME_CHANNELS    // Canaux existants
+};
+
+// Morceau d'un modèle: texte déjà sérialisé suivi d'une valeur à compléter
+struct WelcomeSegment
+{
+    std::string     text;
+    WelcomeField    field;
+};
+
+// Rafale d'enregistrement (001 à 376) et bloc MOTD pré-rendus: seuls le pseudo et
+// les compteurs sont complétés pour chaque client, le tout envoyé en un seul message
+class WelcomeBurst
+{
+private:
+    std::string     _serverName;        // Préfixe des numériques
+    std::string     _creationDate;      // Texte de 003
+    std::vector<std::string> _motd;     // Lignes du MOTD, déjà bornées
+    bool            _motdFromFile;      // false: MOTD intégré (fichier absent ou illisible)
+    std::vector<WelcomeSegment> _burst; // Modèle de la rafale complète
+    std::vector<WelcomeSegment> _motdBlock; // Modèle 375/372/376 seul (commande MOTD)
+    size_t          _burstSize;         // Texte fixe de _burst (réservation à l'assemblage)
+    size_t          _motdBlockSize;     // Texte fixe de _motdBlock
+
+    void build();
+    void addLine(std::vector<WelcomeSegment>& tpl, const std::string& numeric);
+    void addMotdLines(std::vector<WelcomeSegment>& tpl);
+    static void addText(std::vector<WelcomeSegment>& tpl, const std::string& text);
+    static void addField(std::vector<WelcomeSegment>& tpl, WelcomeField field);
+    static size_t textSize(const std::vector<WelcomeSegment>& tpl);
+    static std::string render(const std::vector<WelcomeSegment>& tpl, size_t size, Client* client,
+                              unsigned int users, unsigned int opers, unsigned int channels);
+
+public:
+    WelcomeBurst();
+
+    // Construction des modèles et rechargement du MOTD
+    void init(const std::string& serverName, const std::string& creationDate);
+    bool loadMotd(const std::string& path);
+    static std::vector<std::string> isupportTokens();
+
+    // Assemblage pour un client (sans le CRLF final, ajouté par sendMessage)
+    std::string renderBurst(Client* client, unsigned int users, unsigned int opers, unsigned int channels) const;
+    std::string renderMotd(Client* client) const;
+
+    // Comptabilité mémoire
+    size_t getMemoryUsage() const;
+};
+
+#endif
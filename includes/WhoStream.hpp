@@ -0,0 +1,78 @@
+#ifndef WHO_STREAM_HPP
+# define WHO_STREAM_HPP
+
+# include <string>        // Pour les chaînes de caractères
+# include <vector>        // Pour les membres du canal demandé
+# include <map>           // Pour les verdicts par hôte
+
+# include "ReplyStream.hpp"
+
+class Server;
+class Client;
+class Channel;
+
+// Champs WHOX dans l'ordre imposé de la réponse 354 (WHO masque %champs[,jeton])
+# define WHOX_FIELDS "tcuihsnfdlaor"
+// Longueur maximum du jeton de requête WHOX
+# define WHOX_TOKEN_MAX 3
+// Clients examinés au plus par tour pour un masque, même si aucun ne correspond
+# define WHO_SCAN_PER_TURN 512
+
+// Masque préparé une fois par requête: "*" et les noms sans jokers évitent le filtrage par motif
+class WhoMask
+{
+public:
+    enum Kind
+    {
+        MASK_ALL,       // "*" ou "0": tout correspond
+        MASK_LITERAL,   // Pas de jokers: comparaison directe
+        MASK_GLOB       // Motif avec '*' ou '?'
+    };
+
+private:
+    std::string     _pattern;       // Masque en minuscules
+    Kind            _kind;
+
+public:
+    explicit WhoMask(const std::string& mask);
+    Kind getKind() const;
+    bool matches(const std::string& str) const;
+};
+
+// Forme de la cible, qui décide du parcours
+enum WhoTarget
+{
+    WHO_CHANNEL,    // Membres d'un canal, en O(membres)
+    WHO_NICK,       // Un pseudo exact, par l'index des pseudos
+    WHO_MASK        // Tous les clients, filtrés par le masque
+};
+
+// WHO / WHOX - Réponse produite par morceaux, au rythme où la file d'envoi se vide
+class WhoStream : public ReplyStream
+{
+private:
+    Server*         _server;        // Pointeur vers le serveur
+    std::string     _mask;          // Cible telle que demandée (reprise dans 315)
+    WhoTarget       _target;        // Forme de la cible
+    WhoMask         _matcher;       // Masque préparé (WHO_MASK)
+    bool            _operOnly;      // Drapeau 'o': opérateurs seulement
+    std::string     _fields;        // Champs WHOX demandés (vide: réponse 352 classique)
+    std::string     _token;         // Jeton WHOX renvoyé dans chaque ligne
+    std::vector<std::string> _members; // Pseudos des membres au moment de la requête (WHO_CHANNEL)
+    size_t          _nextMember;    // Prochain membre à émettre
+    int             _cursor;        // Dernier fd examiné (WHO_MASK)
+    bool            _visible;       // Le demandeur peut voir le canal (WHO_CHANNEL)
+    std::map<std::string, bool> _hostVerdicts; // Résultat du masque par hôte distinct
+    bool            _started;       // Cible déjà résolue
+
+    void start(Client* client);
+    bool matches(Client* target);
+    Client* next();
+    std::string formatLine(Client* client, Client* target, Channel* channel) const;
+
+public:
+    WhoStream(Server* server, const std::string& mask, const std::string& options);
+    virtual bool pump(Client* client, unsigned int& budget);
+};
+
+#endif
@@ -0,0 +1,642 @@
+#include "../includes/Admission.hpp"
+#include "../includes/Utils.hpp"
+#include <fstream>      // Pour lire le fichier de règles
+#include <cstring>      // Pour memset et memcpy
+#include <cstdlib>      // Pour atoi
+#include <netinet/in.h> // Pour sockaddr_in et sockaddr_in6
+#include <arpa/inet.h>  // Pour inet_pton et inet_ntop
+
+/**
+ * Constructeur de la classe Admission (aucune règle, limite par adresse par défaut)
+ */
+Admission::Admission()
+    : _root(NULL),
+      _nodes(0),
+      _perIpLimit(ADMISSION_DEFAULT_PER_IP),
+      _perIpRejected(0),
+      _rate(0),
+      _burst(0),
+      _tokens(0),
+      _lastRefill(Utils::getMonotonicMicros()),
+      _rateRejected(0),
+      _admitted(0)
+{
+    // vide
+}
+
+/**
+ * Destructeur de la classe Admission: libère l'arbre
+ */
+Admission::~Admission()
+{
+    destroy(_root);
+    _root = NULL;
+}
+
+/**
+ * Libère un sous-arbre
+ * arg node Racine du sous-arbre
+ */
+void Admission::destroy(AdmissionNode* node)
+{
+    if (!node)
+    {
+        return;
+    }
+    destroy(node->child[0]);
+    destroy(node->child[1]);
+    delete node;
+    _nodes--;
+}
+
+/**
+ * Lit le bit de rang donné d'une adresse (0 = bit de poids fort)
+ * arg address Adresse à lire
+ * arg bit Rang du bit
+ * return Valeur du bit
+ */
+bool Admission::testBit(const IpAddress& address, unsigned int bit)
+{
+    return (address.bytes[bit >> 3] >> (7 - (bit & 7))) & 1;
+}
+
+/**
+ * Compte les bits de tête communs à deux adresses
+ * arg a Première adresse
+ * arg b Seconde adresse
+ * arg max Nombre maximum de bits à comparer
+ * return Longueur du préfixe commun, au plus max
+ */
+unsigned int Admission::commonBits(const IpAddress& a, const IpAddress& b, unsigned int max)
+{
+    unsigned int bits = 0;
+    for (int i = 0; i < 16 && bits < max; ++i)
+    {
+        uint8_t diff = a.bytes[i] ^ b.bytes[i];
+        if (diff == 0)
+        {
+            bits += 8;
+            continue;
+        }
+        while (!(diff & 0x80))
+        {
+            diff <<= 1;
+            bits++;
+        }
+        break;
+    }
+    return bits < max ? bits : max;
+}
+
+/**
+ * Met à zéro les bits d'une adresse au-delà d'une longueur de préfixe
+ * arg address Adresse à masquer
+ * arg bits Longueur du préfixe conservé
+ */
+void Admission::maskAddress(IpAddress& address, unsigned int bits)
+{
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        if (bits >= 8 * (i + 1))
+        {
+            continue;
+        }
+        if (bits <= 8 * i)
+        {
+            address.bytes[i] = 0;
+        }
+        else
+        {
+            address.bytes[i] &= static_cast<uint8_t>(0xff << (8 - (bits - 8 * i)));
+        }
+    }
+}
+
+/**
+ * Alloue un nœud vide
+ * arg key Préfixe (masqué à la longueur bits)
+ * arg bits Longueur du préfixe
+ * arg parent Nœud parent
+ * return Nouveau nœud
+ */
+AdmissionNode* Admission::createNode(const IpAddress& key, unsigned int bits, AdmissionNode* parent)
+{
+    AdmissionNode* node = new AdmissionNode;
+    memset(node, 0, sizeof(*node));
+    node->key = key;
+    maskAddress(node->key, bits);
+    node->bits = bits;
+    node->parent = parent;
+    node->action = ADMISSION_NONE;
+    _nodes++;
+    return node;
+}
+
+/**
+ * Trouve ou crée le nœud d'un préfixe
+ * arg address Adresse du préfixe
+ * arg bits Longueur du préfixe
+ * return Nœud du préfixe
+ */
+AdmissionNode* Admission::insert(const IpAddress& address, unsigned int bits)
+{
+    IpAddress key = address;
+    maskAddress(key, bits);
+
+    AdmissionNode** link = &_root;
+    AdmissionNode* parent = NULL;
+    while (*link)
+    {
+        AdmissionNode* node = *link;
+        unsigned int common = commonBits(node->key, key, node->bits < bits ? node->bits : bits);
+        if (common == node->bits)
+        {
+            if (node->bits == bits)
+            {
+                return node;
+            }
+            // Le nœud englobe le préfixe: descendre du côté du bit suivant
+            parent = node;
+            link = &node->child[testBit(key, node->bits)];
+            continue;
+        }
+
+        // Le préfixe s'écarte du nœud avant sa fin
+        AdmissionNode* created = createNode(key, bits, parent);
+        if (common == bits)
+        {
+            // Le nouveau préfixe englobe le nœud
+            created->child[testBit(node->key, bits)] = node;
+            node->parent = created;
+            *link = created;
+            return created;
+        }
+        // Les deux préfixes divergent: un embranchement les sépare
+        AdmissionNode* branch = createNode(key, common, parent);
+        branch->child[testBit(node->key, common)] = node;
+        branch->child[testBit(key, common)] = created;
+        node->parent = branch;
+        created->parent = branch;
+        *link = branch;
+        return created;
+    }
+
+    *link = createNode(key, bits, parent);
+    return *link;
+}
+
+/**
+ * Supprime un nœud devenu inutile, et l'embranchement qu'il laisse derrière lui
+ * arg node Nœud sans règle ni connexion
+ */
+void Admission::erase(AdmissionNode* node)
+{
+    while (node && node->action == ADMISSION_NONE && node->hostConnections == 0)
+    {
+        if (node->child[0] && node->child[1])
+        {
+            return;     // Embranchement encore nécessaire
+        }
+        AdmissionNode* child = node->child[0] ? node->child[0] : node->child[1];
+        AdmissionNode* parent = node->parent;
+        AdmissionNode** link = parent ? &parent->child[parent->child[1] == node] : &_root;
+        *link = child;
+        if (child)
+        {
+            child->parent = parent;
+        }
+        delete node;
+        _nodes--;
+        if (child)
+        {
+            return;     // Le parent garde le même nombre de fils
+        }
+        node = parent;  // Le parent n'a peut-être plus qu'un fils
+    }
+}
+
+/**
+ * Parcourt l'arbre le long d'une adresse sans rien allouer
+ * arg address Adresse recherchée
+ * arg path Règles rencontrées, de la plus large à la plus spécifique
+ * arg host Nœud de l'adresse exacte s'il existe (NULL sinon)
+ * return Nombre de règles rencontrées
+ */
+unsigned int Admission::collectRules(const IpAddress& address, AdmissionNode** path, AdmissionNode** host) const
+{
+    unsigned int count = 0;
+    *host = NULL;
+    AdmissionNode* node = _root;
+    while (node && commonBits(node->key, address, node->bits) == node->bits)
+    {
+        if (node->action != ADMISSION_NONE)
+        {
+            path[count++] = node;
+        }
+        if (node->bits == ADMISSION_ADDRESS_BITS)
+        {
+            *host = node;
+            break;
+        }
+        node = node->child[testBit(address, node->bits)];
+    }
+    return count;
+}
+
+/**
+ * Prend un jeton dans le seau du débit global
+ * return true si l'acceptation est permise, false si le débit est dépassé
+ */
+bool Admission::takeToken()
+{
+    if (_rate == 0)
+    {
+        return true;
+    }
+    uint64_t now = Utils::getMonotonicMicros();
+    _tokens += (now - _lastRefill) * _rate / 1000;
+    _lastRefill = now;
+    if (_tokens > static_cast<uint64_t>(_burst) * 1000)
+    {
+        _tokens = static_cast<uint64_t>(_burst) * 1000;
+    }
+    if (_tokens < 1000)
+    {
+        return false;
+    }
+    _tokens -= 1000;
+    return true;
+}
+
+/**
+ * Décide si une connexion entrante est admise
+ * Le refus ne fait que parcourir l'arbre (O(longueur du préfixe)) et n'alloue rien
+ * arg address Adresse du client
+ * return true si la connexion est admise (et comptée), false sinon
+ */
+bool Admission::admit(const IpAddress& address)
+{
+    AdmissionNode* path[ADMISSION_ADDRESS_BITS + 1];
+    AdmissionNode* host;
+    unsigned int count = collectRules(address, path, &host);
+
+    // Du plus spécifique au plus large: deny/allow tranchent, chaque limite traversée doit tenir
+    bool allowed = false;
+    unsigned int i = count;
+    while (i > 0 && !allowed)
+    {
+        AdmissionNode* rule = path[--i];
+        if (rule->action == ADMISSION_DENY)
+        {
+            rule->rejected++;
+            return false;
+        }
+        if (rule->action == ADMISSION_ALLOW)
+        {
+            allowed = true;
+        }
+        else if (rule->connections >= rule->limit)
+        {
+            rule->rejected++;
+            return false;
+        }
+    }
+    if (!allowed)
+    {
+        if (_perIpLimit > 0 && host && host->hostConnections >= _perIpLimit)
+        {
+            _perIpRejected++;
+            return false;
+        }
+        if (!takeToken())
+        {
+            _rateRejected++;
+            return false;
+        }
+    }
+
+    // Admis: compter la connexion dans les préfixes limités jusqu'à la règle allow
+    for (i = count; i > 0; --i)
+    {
+        AdmissionNode* rule = path[i - 1];
+        rule->admitted++;
+        if (rule->action == ADMISSION_ALLOW)
+        {
+            break;
+        }
+        rule->connections++;
+    }
+    if (!host)
+    {
+        host = insert(address, ADMISSION_ADDRESS_BITS);
+    }
+    host->hostConnections++;
+    _admitted++;
+    return true;
+}
+
+/**
+ * Retire une connexion fermée des compteurs
+ * arg address Adresse du client admis
+ */
+void Admission::release(const IpAddress& address)
+{
+    AdmissionNode* path[ADMISSION_ADDRESS_BITS + 1];
+    AdmissionNode* host;
+    unsigned int count = collectRules(address, path, &host);
+
+    for (unsigned int i = count; i > 0; --i)
+    {
+        AdmissionNode* rule = path[i - 1];
+        if (rule->action != ADMISSION_LIMIT)
+        {
+            break;
+        }
+        if (rule->connections > 0)
+        {
+            rule->connections--;
+        }
+    }
+    if (host && host->hostConnections > 0)
+    {
+        host->hostConnections--;
+        erase(host);
+    }
+}
+
+/**
+ * Ajoute une règle sur un préfixe
+ * arg prefix Préfixe CIDR (ex: 10.0.0.0/8, 2001:db8::/32, 192.0.2.1)
+ * arg action Action de la règle
+ * arg limit Connexions simultanées permises (ADMISSION_LIMIT)
+ * return true si la règle a été ajoutée, false si le préfixe est invalide
+ */
+bool Admission::addRule(const std::string& prefix, AdmissionAction action, unsigned int limit)
+{
+    IpAddress address;
+    unsigned int bits;
+    if (!parsePrefix(prefix, address, bits))
+    {
+        return false;
+    }
+    AdmissionNode* node = insert(address, bits);
+    node->action = action;
+    node->limit = limit;
+    return true;
+}
+
+/**
+ * Définit la limite de connexions simultanées par adresse
+ * arg limit Nombre de connexions (0 = illimité)
+ */
+void Admission::setPerIpLimit(unsigned int limit)
+{
+    _perIpLimit = limit;
+}
+
+/**
+ * Définit le débit global d'acceptation
+ * arg perSecond Acceptations par seconde (0 = illimité)
+ * arg burst Acceptations permises d'un coup
+ */
+void Admission::setRate(unsigned int perSecond, unsigned int burst)
+{
+    _rate = perSecond;
+    _burst = burst > 0 ? burst : perSecond;
+    _tokens = static_cast<uint64_t>(_burst) * 1000;
+    _lastRefill = Utils::getMonotonicMicros();
+}
+
+/**
+ * Charge les règles depuis un fichier de configuration
+ * Format, une directive par ligne:
+ *   allow <préfixe> | deny <préfixe> | limit <préfixe> <connexions>
+ *   perip <connexions> | rate <par seconde> [rafale]
+ * arg path Chemin du fichier
+ */
+void Admission::load(const std::string& path)
+{
+    std::ifstream file(path.c_str());
+
+    // Sans fichier, la boucle locale reste exemptée
+    if (!file.is_open())
+    {
+        addRule("127.0.0.0/8", ADMISSION_ALLOW, 0);
+        addRule("::1", ADMISSION_ALLOW, 0);
+        Utils::logMessage("Admission: fichier " + path + " non trouvé, " + Utils::toString(_perIpLimit) +
+                          " connexions par adresse");
+        return;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    int rules = 0;
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        std::vector<std::string> words = Utils::split(line, ' ');
+        if (words.empty() || words[0][0] == '#')
+        {
+            continue;
+        }
+
+        bool valid = false;
+        if ((words[0] == "allow" || words[0] == "deny") && words.size() == 2)
+        {
+            valid = addRule(words[1], words[0] == "allow" ? ADMISSION_ALLOW : ADMISSION_DENY, 0);
+        }
+        else if (words[0] == "limit" && words.size() == 3 && atoi(words[2].c_str()) >= 0)
+        {
+            valid = addRule(words[1], ADMISSION_LIMIT, atoi(words[2].c_str()));
+        }
+        else if (words[0] == "perip" && words.size() == 2 && atoi(words[1].c_str()) >= 0)
+        {
+            setPerIpLimit(atoi(words[1].c_str()));
+            valid = true;
+            rules--;
+        }
+        else if (words[0] == "rate" && (words.size() == 2 || words.size() == 3) && atoi(words[1].c_str()) >= 0)
+        {
+            setRate(atoi(words[1].c_str()), words.size() == 3 ? atoi(words[2].c_str()) : 0);
+            valid = true;
+            rules--;
+        }
+
+        if (valid)
+        {
+            rules++;
+        }
+        else
+        {
+            Utils::logMessage("Admission: ligne " + Utils::toString(lineNumber) + " de " + path + " ignorée: " + line, true);
+        }
+    }
+
+    Utils::logMessage("Admission: " + Utils::toString(rules) + " règles chargées depuis " + path);
+}
+
+/**
+ * Convertit l'adresse d'un socket en adresse sur 16 octets
+ * arg addr Adresse renvoyée par accept
+ * arg address Adresse convertie (IPv4 rangée dans ::ffff:0:0/96)
+ * return true si la famille est gérée, false sinon
+ */
+bool Admission::fromSockaddr(const struct sockaddr* addr, IpAddress& address)
+{
+    memset(&address, 0, sizeof(address));
+    if (addr->sa_family == AF_INET)
+    {
+        const struct sockaddr_in* in = reinterpret_cast<const struct sockaddr_in*>(addr);
+        address.bytes[10] = 0xff;
+        address.bytes[11] = 0xff;
+        memcpy(&address.bytes[12], &in->sin_addr, 4);
+        return true;
+    }
+    if (addr->sa_family == AF_INET6)
+    {
+        const struct sockaddr_in6* in6 = reinterpret_cast<const struct sockaddr_in6*>(addr);
+        memcpy(address.bytes, &in6->sin6_addr, 16);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Lit un préfixe CIDR
+ * arg text Préfixe (adresse seule = adresse exacte)
+ * arg address Adresse du préfixe
+ * arg bits Longueur du préfixe sur 128 bits
+ * return true si le préfixe est valide, false sinon
+ */
+bool Admission::parsePrefix(const std::string& text, IpAddress& address, unsigned int& bits)
+{
+    size_t slash = text.find('/');
+    std::string host = text.substr(0, slash);
+    int length = -1;
+    if (slash != std::string::npos)
+    {
+        std::string suffix = text.substr(slash + 1);
+        if (suffix.empty() || suffix.find_first_not_of("0123456789") != std::string::npos)
+        {
+            return false;
+        }
+        length = atoi(suffix.c_str());
+    }
+
+    memset(&address, 0, sizeof(address));
+    if (inet_pton(AF_INET, host.c_str(), &address.bytes[12]) == 1)
+    {
+        if (length > 32)
+        {
+            return false;
+        }
+        address.bytes[10] = 0xff;
+        address.bytes[11] = 0xff;
+        bits = 96 + (length < 0 ? 32 : length);
+        return true;
+    }
+    if (inet_pton(AF_INET6, host.c_str(), address.bytes) == 1)
+    {
+        if (length > ADMISSION_ADDRESS_BITS)
+        {
+            return false;
+        }
+        bits = length < 0 ? ADMISSION_ADDRESS_BITS : length;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Affiche une adresse (notation IPv4 pour ::ffff:a.b.c.d)
+ * arg address Adresse à afficher
+ * return Adresse au format texte
+ */
+std::string Admission::formatAddress(const IpAddress& address)
+{
+    static const uint8_t mapped[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff };
+    char buffer[INET6_ADDRSTRLEN];
+
+    if (memcmp(address.bytes, mapped, sizeof(mapped)) == 0)
+    {
+        inet_ntop(AF_INET, &address.bytes[12], buffer, sizeof(buffer));
+    }
+    else
+    {
+        inet_ntop(AF_INET6, address.bytes, buffer, sizeof(buffer));
+    }
+    return buffer;
+}
+
+/**
+ * Affiche un préfixe (longueur IPv4 pour ::ffff:0:0/96)
+ * arg address Adresse du préfixe
+ * arg bits Longueur du préfixe sur 128 bits
+ * return Préfixe au format CIDR
+ */
+std::string Admission::formatPrefix(const IpAddress& address, unsigned int bits)
+{
+    std::string text = formatAddress(address);
+    if (bits >= 96 && text.find(':') == std::string::npos)
+    {
+        return text + "/" + Utils::toString(bits - 96);
+    }
+    return text + "/" + Utils::toString(bits);
+}
+
+/**
+ * Ajoute les règles d'un sous-arbre au rapport, par préfixe croissant
+ * arg node Racine du sous-arbre
+ * arg lines Lignes du rapport
+ */
+void Admission::describe(const AdmissionNode* node, std::vector<std::string>& lines) const
+{
+    if (!node)
+    {
+        return;
+    }
+    if (node->action != ADMISSION_NONE)
+    {
+        std::string line = "Rule " + formatPrefix(node->key, node->bits);
+        if (node->action == ADMISSION_ALLOW)
+        {
+            line += " allow";
+        }
+        else if (node->action == ADMISSION_DENY)
+        {
+            line += " deny";
+        }
+        else
+        {
+            line += " limit " + Utils::toString(node->limit) + " open " + Utils::toString(node->connections);
+        }
+        line += " admitted " + Utils::sizeToString(node->admitted) + " rejected " + Utils::sizeToString(node->rejected);
+        lines.push_back(line);
+    }
+    describe(node->child[0], lines);
+    describe(node->child[1], lines);
+}
+
+/**
+ * Produit le rapport des règles et des compteurs
+ * return Lignes du rapport
+ */
+std::vector<std::string> Admission::toLines() const
+{
+    std::vector<std::string> lines;
+    lines.push_back("Admission admitted " + Utils::sizeToString(_admitted) + " nodes " + Utils::sizeToString(_nodes));
+    lines.push_back("Per-IP limit " + Utils::toString(_perIpLimit) + " rejected " + Utils::sizeToString(_perIpRejected));
+    lines.push_back("Accept rate " + Utils::toString(_rate) + "/s burst " + Utils::toString(_burst) +
+                    " rejected " + Utils::sizeToString(_rateRejected));
+    describe(_root, lines);
+    return lines;
+}
+
+/**
+ * Calcule la mémoire occupée par l'arbre
+ * return Nombre d'octets alloués pour les nœuds
+ */
+size_t Admission::getMemoryUsage() const
+{
+    return _nodes * sizeof(AdmissionNode);
+}
@@ -3,6 +3,7 @@
 #include "../includes/Client.hpp"
 #include "../includes/Channel.hpp"
 #include "../includes/Utils.hpp"
+#include "../includes/MemoryReport.hpp"
 #include <fstream>
 #include <sstream>
 #include <ctime>
@@ -802,7 +803,7 @@ void Bot::sayToUser(const std::string& nickname, const std::string& message)
     }
 
     // Envoyer le message
-    client->sendMessage(":" + _nickname + "!" + _username + "@localhost PRIVMSG " + nickname + " :" + message);
+    client->sendMessage(":" + _nickname + "!" + _username + "@localhost PRIVMSG " + nickname + " :" + message, LANE_BULK);
 
     // Log d'envoi de message
     Utils::logMessage("Bot IRC a envoyé un message à " + nickname + ": " + message);
@@ -1114,4 +1115,35 @@ void Bot::stats(Client* client)
     client->sendMessage(":" + _nickname + " PRIVMSG " + client->getNickname() + " :Clients connectés: " + Utils::toString(clientCount));
     client->sendMessage(":" + _nickname + " PRIVMSG " + client->getNickname() + " :Canaux actifs: " + Utils::toString(channelCount));
     client->sendMessage(":" + _nickname + " PRIVMSG " + client->getNickname() + " :Date de création du serveur: " + _server->getCreationDate());
+    client->sendMessage(":" + _nickname + " PRIVMSG " + client->getNickname() + " :Boucle d'événements: " + _server->getLoopMonitor().toString());
+
+    // Mémoire comptabilisée par sous-système
+    MemoryReport report;
+    _server->collectMemoryReport(report);
+    client->sendMessage(":" + _nickname + " PRIVMSG " + client->getNickname() + " :Mémoire comptabilisée: " + Utils::sizeToString(report.getTotal()) + " octets");
+}
+
+/**
+ * Estime la mémoire occupée par le bot (réponses, cooldowns, client du bot)
+ * return Nombre d'octets
+ */
+size_t Bot::getMemoryUsage() const
+{
+    size_t bytes = sizeof(Bot) + Utils::stringMemory(_nickname) + Utils::stringMemory(_username) +
+                   Utils::stringMemory(_realname);
+
+    bytes += _responses.capacity() * sizeof(BotResponse);
+    for (size_t i = 0; i < _responses.size(); ++i)
+    {
+        bytes += Utils::stringMemory(_responses[i].trigger) + Utils::stringMemory(_responses[i].response);
+    }
+    for (std::map<std::string, time_t>::const_iterator it = _cooldowns.begin(); it != _cooldowns.end(); ++it)
+    {
+        bytes += MEMORY_TREE_NODE_OVERHEAD + sizeof(std::map<std::string, time_t>::value_type) + Utils::stringMemory(it->first);
+    }
+    if (_botClient)
+    {
+        bytes += _botClient->getMemoryUsage() + _botClient->getRecvQMemory() + _botClient->getSendQMemory();
+    }
+    return bytes;
 }
\ No newline at end of file
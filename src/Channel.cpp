@@ -1,6 +1,8 @@
 #include "../includes/Channel.hpp"
 #include "../includes/Client.hpp"
 #include "../includes/Utils.hpp"
+#include "../includes/MemoryReport.hpp"
+#include "../includes/Probes.hpp"
 
 /**
  * Constructeur de la classe Channel
@@ -10,11 +12,14 @@
 Channel::Channel(const std::string& name, Client* creator)
     : _name(name),                // Initialiser le nom du canal
       _topic(""),                 // Pas de sujet initial
+      _topicTime(0),              // Sujet jamais défini
       _modes(0),                  // Pas de modes initiaux
       _password(""),              // Pas de mot de passe initial
       _userLimit(0),              // Pas de limite d'utilisateurs
       _creationTime(time(NULL))   // Timestamp de création
 {
+    invalidateNames();  // Aucune variante de NAMES construite
+
     // Ajouter le créateur comme client et opérateur
     addClient(creator, true);
 
@@ -61,6 +66,7 @@ void Channel::setTopic(const std::string& topic, Client* setter)
 {
     // Mettre à jour le sujet
     _topic = topic;
+    _topicTime = time(NULL);
 
     // Log de changement de sujet
     if (setter)
@@ -73,6 +79,15 @@ void Channel::setTopic(const std::string& topic, Client* setter)
     }
 }
 
+/**
+ * Récupère l'heure du dernier changement de sujet
+ * return Horodatage, ou 0 si le sujet n'a jamais été défini
+ */
+time_t Channel::getTopicTime() const
+{
+    return _topicTime;
+}
+
 /**
  * Récupère les modes du canal
  * return Modes du canal
@@ -162,6 +177,15 @@ void Channel::setMode(ChannelMode mode, bool enabled)
         _modes &= ~mode;
     }
 
+    // Le canal entre dans la liste 319 de ses membres ou en sort
+    if (mode == MODE_SECRET)
+    {
+        for (std::map<Client*, unsigned int>::iterator it = _clients.begin(); it != _clients.end(); ++it)
+        {
+            it->first->invalidateWhois();
+        }
+    }
+
     // Log de changement de mode
     std::string modeChar;
     switch (mode)
@@ -178,6 +202,12 @@ void Channel::setMode(ChannelMode mode, bool enabled)
         case MODE_USER_LIMIT:
             modeChar = "l";
             break;
+        case MODE_SECRET:
+            modeChar = "s";
+            break;
+        case MODE_PRIVATE:
+            modeChar = "p";
+            break;
         default:
             modeChar = "?";
             break;
@@ -208,6 +238,9 @@ void Channel::addClient(Client* client, bool asOperator)
     // Ajouter le client à la map
     _clients[client] = asOperator ? USER_MODE_OPERATOR : 0;
 
+    // Un JOIN ajoute son entrée aux variantes NAMES déjà construites, sans les refaire
+    refreshNames(client);
+
     // Faire rejoindre le canal au client
     client->joinChannel(this);
 
@@ -235,8 +268,12 @@ void Channel::removeClient(Client* client)
         return;
     }
 
-    // Supprimer le client de la map
+    // Supprimer le client de la map et son entrée des listes NAMES
     _clients.erase(it);
+    for (unsigned int variant = 0; variant < NAMES_VARIANTS; ++variant)
+    {
+        _namesEntries[variant].erase(client);
+    }
 
     // Faire quitter le canal au client
     client->leaveChannel(this);
@@ -392,6 +429,8 @@ void Channel::setOperator(Client* client, bool op)
     {
         it->second &= ~USER_MODE_OPERATOR;
     }
+    client->invalidateWhois(); // Préfixe @ de la liste 319
+    refreshNames(client);
 
     // Log de changement de statut d'opérateur
     Utils::logMessage("Client " + client->getNickname() + " est " + (op ? "maintenant" : "plus un") +
@@ -451,6 +490,8 @@ void Channel::setVoice(Client* client, bool voice)
     {
         it->second &= ~USER_MODE_VOICE;
     }
+    client->invalidateWhois(); // Préfixe + de la liste 319
+    refreshNames(client);
 
     // Log de changement de droit de parole
     Utils::logMessage("Client " + client->getNickname() + " a " + (voice ? "maintenant" : "perdu") +
@@ -499,6 +540,166 @@ void Channel::removeInvite(const std::string& nickname)
     _invitedUsers.erase(Utils::toLower(nickname));
 }
 
+/**
+ * Récupère le nombre d'invitations en attente
+ * return Nombre d'invitations
+ */
+unsigned int Channel::getInviteCount() const
+{
+    return _invitedUsers.size();
+}
+
+/**
+ * Estime la mémoire occupée par le canal (structure, nom, mot de passe)
+ * return Nombre d'octets
+ */
+size_t Channel::getMemoryUsage() const
+{
+    return sizeof(Channel) + Utils::stringMemory(_name) + Utils::stringMemory(_password);
+}
+
+/**
+ * Estime la mémoire occupée par la table des membres
+ * return Nombre d'octets
+ */
+size_t Channel::getMembersMemory() const
+{
+    size_t bytes = _clients.size() * (sizeof(std::map<Client*, unsigned int>::value_type) + MEMORY_TREE_NODE_OVERHEAD);
+    // Entrées NAMES en cache
+    for (unsigned int variant = 0; variant < NAMES_VARIANTS; ++variant)
+    {
+        for (std::map<Client*, std::string>::const_iterator it = _namesEntries[variant].begin();
+             it != _namesEntries[variant].end(); ++it)
+        {
+            bytes += MEMORY_TREE_NODE_OVERHEAD + sizeof(std::map<Client*, std::string>::value_type) +
+                     Utils::stringMemory(it->second);
+        }
+    }
+    return bytes;
+}
+
+/**
+ * Estime la mémoire occupée par la liste des invitations
+ * return Nombre d'octets
+ */
+size_t Channel::getInvitesMemory() const
+{
+    size_t bytes = 0;
+    for (std::set<std::string>::const_iterator it = _invitedUsers.begin(); it != _invitedUsers.end(); ++it)
+    {
+        bytes += sizeof(std::string) + MEMORY_TREE_NODE_OVERHEAD + Utils::stringMemory(*it);
+    }
+    return bytes;
+}
+
+/**
+ * Estime la mémoire occupée par le sujet du canal
+ * return Nombre d'octets
+ */
+size_t Channel::getTopicMemory() const
+{
+    return Utils::stringMemory(_topic);
+}
+
+/**
+ * Met en forme l'entrée d'un membre dans la liste NAMES
+ * arg client Membre
+ * arg modes Modes du membre dans le canal (UserMode)
+ * arg variant Combinaison de CAP_MULTI_PREFIX et CAP_USERHOST_IN_NAMES
+ * return Pseudo (ou nick!user@host) précédé de ses préfixes
+ */
+std::string Channel::namesEntry(Client* client, unsigned int modes, unsigned int variant) const
+{
+    std::string entry;
+    if (modes & USER_MODE_OPERATOR)
+    {
+        entry += "@";
+    }
+    // Sans multi-prefix, seul le statut le plus élevé est montré
+    if ((modes & USER_MODE_VOICE) && (entry.empty() || (variant & CAP_MULTI_PREFIX)))
+    {
+        entry += "+";
+    }
+    entry += client->getNickname();
+    if (variant & CAP_USERHOST_IN_NAMES)
+    {
+        entry += "!" + client->getUsername() + "@" + client->getHostname();
+    }
+    return entry;
+}
+
+/**
+ * Retourne les entrées NAMES d'une variante, construites en entier une seule fois
+ * puis corrigées membre par membre (JOIN, PART, KICK, QUIT, NICK, +o/+v)
+ * arg variant Combinaison de CAP_MULTI_PREFIX et CAP_USERHOST_IN_NAMES
+ * return Entrée formatée de chaque membre
+ */
+const std::map<Client*, std::string>& Channel::getNamesEntries(unsigned int variant)
+{
+    variant &= (CAP_MULTI_PREFIX | CAP_USERHOST_IN_NAMES);
+    if (!_namesValid[variant])
+    {
+        _namesEntries[variant].clear();
+        for (std::map<Client*, unsigned int>::const_iterator it = _clients.begin(); it != _clients.end(); ++it)
+        {
+            _namesEntries[variant][it->first] = namesEntry(it->first, it->second, variant);
+        }
+        _namesValid[variant] = true;
+    }
+    return _namesEntries[variant];
+}
+
+/**
+ * Reformate l'entrée d'un membre dans les variantes déjà construites (arrivée, pseudo ou statut changé)
+ * arg client Membre dont l'entrée a changé
+ */
+void Channel::refreshNames(Client* client)
+{
+    std::map<Client*, unsigned int>::const_iterator it = _clients.find(client);
+    if (it == _clients.end())
+    {
+        return;
+    }
+    for (unsigned int variant = 0; variant < NAMES_VARIANTS; ++variant)
+    {
+        if (_namesValid[variant])
+        {
+            _namesEntries[variant][client] = namesEntry(client, it->second, variant);
+        }
+    }
+}
+
+/**
+ * Vide toutes les variantes de la liste NAMES (reconstruites à la prochaine demande)
+ */
+void Channel::invalidateNames()
+{
+    for (unsigned int variant = 0; variant < NAMES_VARIANTS; ++variant)
+    {
+        _namesValid[variant] = false;
+        _namesEntries[variant].clear();
+    }
+}
+
+/**
+ * Envoie la liste des membres (353, une ligne par morceau) puis 366
+ * arg client Client qui reçoit la liste
+ */
+void Channel::sendNames(Client* client)
+{
+    // '@' canal secret, '*' canal privé, '=' canal public
+    std::string type = hasMode(MODE_SECRET) ? "@" : (hasMode(MODE_PRIVATE) ? "*" : "=");
+    const std::map<Client*, std::string>& entries = getNamesEntries(client->getCaps());
+    std::vector<std::string> names;
+    names.reserve(entries.size());
+    for (std::map<Client*, std::string>::const_iterator it = entries.begin(); it != entries.end(); ++it)
+    {
+        names.push_back(it->second);
+    }
+    client->sendReplyList("353 " + client->getNickname() + " " + type + " " + _name + " :", names, ' ');
+    client->sendReply("366 " + client->getNickname() + " " + _name + " :End of /NAMES list");
+}
+
 /**
  * Diffuse un message à tous les clients du canal
  * arg message Message à diffuser
@@ -506,14 +707,41 @@ void Channel::removeInvite(const std::string& nickname)
  */
 void Channel::broadcast(const std::string& message, Client* exclude)
 {
+    size_t fanout = 0;
+
     // Parcourir tous les clients
     for (std::map<Client*, unsigned int>::iterator it = _clients.begin(); it != _clients.end(); ++it) {
         // Vérifier si le client doit être exclu
         if (it->first != exclude) {
             // Envoyer le message
-            it->first->sendMessage(message);
+            it->first->sendMessage(message, LANE_BULK);
+            fanout++;
+        }
+    }
+    IRC_PROBE2(channel__broadcast, _name.c_str(), fanout);
+}
+
+/**
+ * Diffuse un message aux membres qui ne l'ont pas déjà reçu pour le même événement
+ * arg message Message à diffuser
+ * arg generation Numéro de l'événement (Server::broadcastToPeers)
+ * return Nombre de membres servis par ce canal
+ */
+size_t Channel::broadcastStamped(const std::string& message, unsigned long generation)
+{
+    size_t fanout = 0;
+    for (std::map<Client*, unsigned int>::iterator it = _clients.begin(); it != _clients.end(); ++it)
+    {
+        if (it->first->getFanoutStamp() == generation)
+        {
+            continue;
         }
+        it->first->setFanoutStamp(generation);
+        it->first->sendMessage(message, LANE_BULK);
+        fanout++;
     }
+    IRC_PROBE2(channel__broadcast, _name.c_str(), fanout);
+    return fanout;
 }
 
 /**
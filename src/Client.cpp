@@ -2,8 +2,11 @@
 #include "../includes/Server.hpp"
 #include "../includes/Channel.hpp"
 #include "../includes/Utils.hpp"
+#include "../includes/MemoryReport.hpp"
+#include "../includes/Probes.hpp"
 #include <unistd.h>  // Pour close() et autres fonctions POSIX
 #include <cstring>   // Pour strerror
+#include <sys/uio.h> // Pour struct iovec (envois groupés)
 
 /**
  * Constructeur de la classe Client
@@ -15,23 +18,91 @@ Client::Client(int fd, Server* server)
       _nickname(""),              // Pseudo vide initialement
       _username(""),              // Nom d'utilisateur vide initialement
       _hostname(""),              // Nom d'hôte vide initialement
+      _admitted(false),           // Pas encore compté par le contrôle d'admission
+      _listener(NULL),            // Port de réception inconnu initialement
       _realname(""),              // Nom réel vide initialement
       _buffer(""),                // Buffer de réception vide initialement
       _status(CONNECTING),        // État initial: se connecte
       _server(server),            // Pointeur vers le serveur
+      _whoisValid(false),         // Liste 319 construite à la première demande
+      _whoisSecret(false),
+      _corked(0),                 // Envois immédiats
       _isAway(false),             // Client n'est pas absent initialement
       _isOperator(false),         // Client n'est pas opérateur initialement
-      _lastPong("")               // Pas de PONG reçu initialement
+      _quitMessage(""),           // "Connection closed" si aucune raison n'est donnée
+      _fanoutStamp(0),
+      _caps(0),                   // Aucune capacité négociée
+      _online(false),             // Annoncé à MONITOR une fois enregistré
+      _capNegotiating(false),
+      _lastPong(0),               // Pas de PONG reçu initialement
+      _pingSentAt(0),             // Pas de PING envoyé initialement
+      _awaitingPong(false),
+      _timer(this, CLIENT_TIMER_KEEPALIVE),
+      _floodTimer(this, CLIENT_TIMER_FLOOD),
+      _floodTime(0),
+      _floodDeferrals(0),
+      _runnable(false),
+      _pending(false),
+      _sendQ(0),                  // File d'envoi vide initialement
+      _bulkPartial(false),
+      _connectTime(time(NULL)),   // Heure de connexion
+      _lastActive(_connectTime),
+      _messagesSent(0),
+      _bytesSent(0),
+      _messagesReceived(0),
+      _bytesReceived(0),
+      _lastRecvTime(Utils::getMonotonicMicros())
 {
+    memset(&_address, 0, sizeof(_address));
+    _laneSendQ[LANE_PRIORITY] = 0;
+    _laneSendQ[LANE_BULK] = 0;
+
+    // Le client doit terminer son enregistrement dans le délai imparti (pas le bot)
+    if (_fd >= 0)
+    {
+        _server->getTimerWheel().schedule(&_timer, REGISTRATION_TIMEOUT_MS);
+    }
+
     // Log de création du client
     Utils::logMessage("Client créé avec fd " + Utils::toString(_fd));
 }
 
+/**
+ * Constructeur du timer d'un client
+ * arg client Client propriétaire
+ */
+ClientTimer::ClientTimer(Client* client, ClientTimerKind kind)
+    : _client(client),
+      _kind(kind)
+{
+    // vide
+}
+
+/**
+ * Échéance: laisser le client décider (déconnexion, PING, réarmement ou reprise)
+ */
+void ClientTimer::expire()
+{
+    if (_kind == CLIENT_TIMER_FLOOD)
+    {
+        _client->onFloodTimer();
+        return;
+    }
+    _client->onTimer();
+}
+
 /**
  * Destructeur de la classe Client
  */
 Client::~Client()
 {
+    // Libérer les réponses longues non terminées
+    while (!_streams.empty())
+    {
+        delete _streams.front();
+        _streams.pop();
+    }
+
     // Log de destruction du client
     Utils::logMessage("Client détruit: " + toString());
 }
@@ -118,6 +189,61 @@ void Client::setHostname(const std::string& hostname)
     _hostname = hostname;
 }
 
+/**
+ * Récupère l'adresse du client
+ * return Adresse sur 16 octets
+ */
+const IpAddress& Client::getAddress() const
+{
+    return _address;
+}
+
+/**
+ * Définit l'adresse admise du client
+ * arg address Adresse comptée par le contrôle d'admission
+ */
+void Client::setAddress(const IpAddress& address)
+{
+    _address = address;
+    _admitted = true;
+}
+
+/**
+ * Vérifie si l'adresse du client est comptée par le contrôle d'admission
+ * return true si la connexion doit être libérée à la fermeture
+ */
+bool Client::isAdmitted() const
+{
+    return _admitted;
+}
+
+/**
+ * Récupère le port sur lequel le client s'est connecté
+ * return Socket en écoute, ou NULL pour le bot
+ */
+Listener* Client::getListener() const
+{
+    return _listener;
+}
+
+/**
+ * Définit le port sur lequel le client s'est connecté
+ * arg listener Socket en écoute
+ */
+void Client::setListener(Listener* listener)
+{
+    _listener = listener;
+}
+
+/**
+ * Récupère la classe de connexion du client
+ * return Classe du port de réception ("default" pour le bot)
+ */
+std::string Client::getConnectionClass() const
+{
+    return _listener ? _listener->getClassName() : LISTENER_DEFAULT_CLASS;
+}
+
 /**
  * Récupère le nom réel du client
  * return Nom réel
@@ -192,6 +318,29 @@ void Client::setStatus(ClientStatus status)
 	// Mettre à jour l'état
 	_status = status;
 
+	// Le serveur fermera la connexion à la fin du tour de boucle
+	if (status == REGISTERED || status == DISCONNECTED)
+	{
+		_server->removePendingClient(this);
+	}
+	if (status == DISCONNECTED)
+	{
+		_server->getTimerWheel().cancel(&_timer);
+		_server->getTimerWheel().cancel(&_floodTimer);
+		_server->scheduleRemoval(_fd);
+	}
+
+	// Une fois enregistré, le délai d'enregistrement laisse place au keepalive
+	if (status == REGISTERED && _fd >= 0)
+	{
+		_server->getTimerWheel().schedule(&_timer, KEEPALIVE_INTERVAL_MS);
+	}
+	if (status == REGISTERED && _fd >= 0 && !_online)
+	{
+		_online = true;
+		_server->notifyMonitors(_nickname, this);	// 730 aux clients qui surveillent ce pseudo
+	}
+
 	// Log de changement d'état
 	std::string statusStr;
 	switch (status) {
@@ -230,7 +379,11 @@ bool Client::isOperator() const
  */
 void Client::setOperator(bool op)
 {
-    // Mettre à jour le statut d'opérateur
+    // Mettre à jour le statut d'opérateur (et le compte annoncé par 252)
+    if (op != _isOperator && _server)
+    {
+        _server->updateOperatorCount(op);
+    }
     _isOperator = op;
 
     // Log de changement de statut d'opérateur
@@ -244,6 +397,154 @@ void Client::setOperator(bool op)
     }
 }
 
+/**
+ * Récupère la raison de départ annoncée dans le QUIT
+ * return Raison (vide si aucune)
+ */
+const std::string& Client::getQuitMessage() const
+{
+    return _quitMessage;
+}
+
+/**
+ * Définit la raison de départ annoncée dans le QUIT (QUIT, ping timeout, flood...)
+ * arg message Raison
+ */
+void Client::setQuitMessage(const std::string& message)
+{
+    _quitMessage = message;
+}
+
+/**
+ * Récupère le dernier événement diffusé à ce client
+ * return Numéro de génération
+ */
+unsigned long Client::getFanoutStamp() const
+{
+    return _fanoutStamp;
+}
+
+/**
+ * Marque le client comme servi pour un événement
+ * arg stamp Numéro de génération de l'événement
+ */
+void Client::setFanoutStamp(unsigned long stamp)
+{
+    _fanoutStamp = stamp;
+}
+
+/**
+ * Vérifie si une capacité CAP est activée
+ * arg cap Capacité à vérifier
+ * return true si elle est activée
+ */
+bool Client::hasCap(ClientCap cap) const
+{
+    return (_caps & cap) != 0;
+}
+
+/**
+ * Récupère les capacités CAP activées
+ * return Masque de ClientCap
+ */
+unsigned int Client::getCaps() const
+{
+    return _caps;
+}
+
+/**
+ * Remplace les capacités CAP activées
+ * arg caps Masque de ClientCap
+ */
+void Client::setCaps(unsigned int caps)
+{
+    _caps = caps;
+}
+
+/**
+ * Indique si l'enregistrement attend CAP END
+ * return true pendant la négociation
+ */
+bool Client::isNegotiatingCaps() const
+{
+    return _capNegotiating;
+}
+
+/**
+ * Suspend ou reprend l'enregistrement pendant la négociation CAP
+ * arg negotiating true après CAP LS/REQ, false après CAP END
+ */
+void Client::setNegotiatingCaps(bool negotiating)
+{
+    _capNegotiating = negotiating;
+}
+
+/**
+ * Vérifie si la présence du client a été annoncée (730) aux observateurs MONITOR
+ * return true entre l'enregistrement et la déconnexion
+ */
+bool Client::isOnline() const
+{
+    return _online;
+}
+
+/**
+ * Récupère les pseudos surveillés par MONITOR
+ * return Pseudos en minuscules, dans l'ordre d'ajout
+ */
+const std::vector<std::string>& Client::getMonitored() const
+{
+    return _monitored;
+}
+
+/**
+ * Vérifie si un pseudo est déjà surveillé
+ * arg key Pseudo en minuscules
+ * return true s'il figure dans la liste
+ */
+bool Client::isMonitoring(const std::string& key) const
+{
+    for (size_t i = 0; i < _monitored.size(); ++i)
+    {
+        if (_monitored[i] == key)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Ajoute un pseudo à la liste MONITOR (appelé par Server::addMonitor)
+ * arg key Pseudo en minuscules
+ */
+void Client::addMonitored(const std::string& key)
+{
+    _monitored.push_back(key);
+}
+
+/**
+ * Retire un pseudo de la liste MONITOR (appelé par Server::removeMonitor)
+ * arg key Pseudo en minuscules
+ */
+void Client::removeMonitored(const std::string& key)
+{
+    for (size_t i = 0; i < _monitored.size(); ++i)
+    {
+        if (_monitored[i] == key)
+        {
+            _monitored.erase(_monitored.begin() + i);
+            return;
+        }
+    }
+}
+
+/**
+ * Vide la liste MONITOR et rend sa mémoire
+ */
+void Client::clearMonitored()
+{
+    std::vector<std::string>().swap(_monitored);
+}
+
 /**
  * Ajoute des données au buffer de réception
  * arg data Données à ajouter
@@ -291,6 +592,7 @@ void Client::joinChannel(Channel* channel)
 
     // Ajouter le canal à la liste des canaux du client
     _channels.push_back(channel);
+    invalidateWhois();
 
     // Log de rejointe du canal
     Utils::logMessage("Client " + _nickname + " a rejoint le canal: " + channel->getName());
@@ -315,6 +617,7 @@ void Client::leaveChannel(Channel* channel)
         {
             // Supprimer le canal de la liste
             _channels.erase(it);
+            invalidateWhois();
 
             // Log de départ du canal
             Utils::logMessage("Client " + _nickname + " a quitté le canal: " + channel->getName());
@@ -377,17 +680,120 @@ std::vector<Channel*> Client::getChannels() const
     return _channels;
 }
 
+/**
+ * Marque la liste 319 comme périmée (JOIN, PART, KICK, +o/+v, +s)
+ */
+void Client::invalidateWhois()
+{
+    _whoisValid = false;
+}
+
+/**
+ * Retourne les entrées 319 des canaux non secrets, reconstruites seulement si elles ont été invalidées
+ * return Canaux préfixés (@, +), à découper par sendReplyList
+ */
+const std::vector<std::string>& Client::getWhoisChannels()
+{
+    if (_whoisValid)
+    {
+        return _whoisChannels;
+    }
+
+    _whoisChannels.clear();
+    _whoisSecret = false;
+    for (size_t i = 0; i < _channels.size(); ++i)
+    {
+        // Les canaux secrets dépendent du demandeur: ils sont ajoutés au moment de la réponse
+        if (_channels[i]->hasMode(MODE_SECRET))
+        {
+            _whoisSecret = true;
+            continue;
+        }
+        _whoisChannels.push_back((_channels[i]->isOperator(this) ? "@" : (_channels[i]->hasVoice(this) ? "+" : "")) +
+                                 _channels[i]->getName());
+    }
+    _whoisValid = true;
+    return _whoisChannels;
+}
+
+/**
+ * Indique si le client est dans un canal secret (à filtrer pour chaque demandeur)
+ * return true si au moins un canal est +s
+ */
+bool Client::hasSecretChannels()
+{
+    getWhoisChannels();
+    return _whoisSecret;
+}
+
 /**
  * Envoie un message au client
  * arg message Message à envoyer
+ * arg lane Voie de la file d'envoi (prioritaire par défaut, LANE_BULK pour la diffusion)
  */
-void Client::sendMessage(const std::string& message)
+void Client::sendMessage(const std::string& message, OutputLane lane)
 {
-    // Ajouter le message à la file d'attente
-    _messages.push(message + "\r\n");
+    // Client déjà déconnecté: ne plus rien accumuler
+    if (_status == DISCONNECTED)
+    {
+        return;
+    }
 
-    // Traiter les messages immédiatement
-    processMessages();
+    // Client qui ne lit plus: libérer sa file et le déconnecter
+    size_t limit = (lane == LANE_PRIORITY) ? MAX_SENDQ_PRIORITY : MAX_SENDQ;
+    if (_laneSendQ[lane] + message.length() + 2 > limit)
+    {
+        IRC_PROBE3(sendq__overflow, _fd, _laneSendQ[lane], limit);
+        Utils::logMessage("SendQ dépassée (" + Utils::sizeToString(_laneSendQ[lane]) + " octets, voie " +
+                          (lane == LANE_PRIORITY ? "prioritaire" : "diffusion") + ") pour " + toString(), true);
+        for (int i = 0; i < LANE_COUNT; ++i)
+        {
+            while (!_messages[i].empty())
+            {
+                _messages[i].pop_front();
+            }
+            _laneSendQ[i] = 0;
+        }
+        _sendQ = 0;
+        _bulkPartial = false;
+        _quitMessage = "Max SendQ exceeded";
+        setStatus(DISCONNECTED);
+        return;
+    }
+
+    // Ajouter le message à la file d'attente, rattaché à la ligne tracée en cours
+    OutgoingMessage outgoing;
+    outgoing.data = message + "\r\n";
+    outgoing.traceId = _server->getTracer().current();
+    _messages[lane].push_back(outgoing);
+    _sendQ += outgoing.data.length();
+    _laneSendQ[lane] += outgoing.data.length();
+    _server->getTracer().record(outgoing.traceId, TRACE_ENQUEUE, _fd, outgoing.data.length());
+
+    // Traiter les messages immédiatement, sauf pendant une réponse groupée
+    if (_corked == 0)
+    {
+        processMessages();
+    }
+}
+
+/**
+ * Retient les envois: les messages s'accumulent jusqu'à l'appel correspondant à uncork
+ */
+void Client::cork()
+{
+    _corked++;
+}
+
+/**
+ * Relâche les envois retenus par cork, écrits en un minimum d'appels système
+ */
+void Client::uncork()
+{
+    if (_corked > 0 && --_corked == 0)
+    {
+        processMessages();
+    }
 }
 
 /**
@@ -400,6 +806,41 @@ void Client::sendReply(const std::string& reply)
     sendMessage(":" + _server->getServerName() + " " + reply);
 }
 
+/**
+ * Envoie une liste en une passe, sur autant de lignes que nécessaire: une nouvelle ligne
+ * commence dès que l'élément suivant ferait dépasser IRC_LINE_MAX (préfixe et CRLF compris)
+ * arg head Début de la réponse sans le préfixe du serveur ("353 pseudo = #canal :")
+ * arg items Éléments à lister
+ * arg separator Séparateur entre deux éléments (' ' ou ',')
+ * arg emptyLine Envoyer la ligne sans élément si la liste est vide (ISON, USERHOST)
+ */
+void Client::sendReplyList(const std::string& head, const std::vector<std::string>& items, char separator,
+                           bool emptyLine)
+{
+    // ":serveur " + head + éléments + CRLF
+    size_t used = _server->getServerName().size() + 2 + head.size() + 2;
+    size_t room = used < IRC_LINE_MAX ? IRC_LINE_MAX - used : 0;
+    std::string line;
+    line.reserve(room);
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        if (!line.empty() && line.size() + 1 + items[i].size() > room)
+        {
+            sendReply(head + line);
+            line.clear();
+        }
+        if (!line.empty())
+        {
+            line += separator;
+        }
+        line += items[i];
+    }
+    if (!line.empty() || (items.empty() && emptyLine))
+    {
+        sendReply(head + line);
+    }
+}
+
 /**
  * Envoie une notification au client
  * arg notice Notification à envoyer
@@ -411,18 +852,61 @@ void Client::sendNotice(const std::string& notice)
 }
 
 /**
- * Traite les messages en attente
+ * Traite les messages en attente, voie prioritaire d'abord
  */
 void Client::processMessages()
 {
+    // Le client du bot n'a pas de socket: rien à envoyer, ne pas accumuler
+    if (_fd < 0)
+    {
+        for (int i = 0; i < LANE_COUNT; ++i)
+        {
+            while (!_messages[i].empty())
+            {
+                _messages[i].pop_front();
+            }
+            _laneSendQ[i] = 0;
+        }
+        _sendQ = 0;
+        return;
+    }
+
     // Vérifier s'il y a des messages à envoyer
-    while (!_messages.empty())
+    while (true)
     {
-        // Récupérer le premier message
-        std::string message = _messages.front();
+        // Un message à moitié écrit doit être terminé avant de changer de voie
+        OutputLane lane;
+        if (_bulkPartial || _messages[LANE_PRIORITY].empty())
+        {
+            lane = LANE_BULK;
+        }
+        else
+        {
+            lane = LANE_PRIORITY;
+        }
+        if (_messages[lane].empty())
+        {
+            break;
+        }
+
+        // Regrouper les messages en tête de la voie dans un seul appel système
+        struct iovec iov[SEND_IOV_BATCH];
+        size_t count = 0;
+        size_t total = 0;
+        for (std::deque<OutgoingMessage>::iterator it = _messages[lane].begin();
+             it != _messages[lane].end() && count < SEND_IOV_BATCH; ++it, ++count)
+        {
+            iov[count].iov_base = const_cast<char*>(it->data.data());
+            iov[count].iov_len = it->data.length();
+            total += it->data.length();
+        }
+        struct msghdr header;
+        memset(&header, 0, sizeof(header));
+        header.msg_iov = iov;
+        header.msg_iovlen = count;
 
-        // Envoyer le message
-        ssize_t bytesSent = send(_fd, message.c_str(), message.length(), MSG_NOSIGNAL);
+        // Envoyer les messages
+        ssize_t bytesSent = sendmsg(_fd, &header, MSG_NOSIGNAL);
 
         // Vérifier les erreurs
         if (bytesSent < 0)
@@ -431,6 +915,7 @@ void Client::processMessages()
             if (errno == EAGAIN || errno == EWOULDBLOCK)
             {
                 // Temporaire, attendre
+                IRC_PROBE2(send__eagain, _fd, _sendQ);
                 break;
             }
             else
@@ -440,18 +925,238 @@ void Client::processMessages()
                 setStatus(DISCONNECTED);
                 break;
             }
-        } else if (bytesSent < static_cast<ssize_t>(message.length()))
+        }
+
+        // Comptabiliser les octets effectivement envoyés
+        _server->getLoopMonitor().addBytesFlushed(bytesSent);
+        _bytesSent += bytesSent;
+        _sendQ -= bytesSent;
+        _laneSendQ[lane] -= bytesSent;
+
+        // Retirer les messages complètement envoyés
+        size_t remaining = bytesSent;
+        while (!_messages[lane].empty() && remaining >= _messages[lane].front().data.length())
+        {
+            remaining -= _messages[lane].front().data.length();
+            _server->getTracer().record(_messages[lane].front().traceId, TRACE_SEND, _fd,
+                                        _messages[lane].front().data.length());
+            _messages[lane].pop_front();
+            _messagesSent++;
+            if (lane == LANE_BULK)
+            {
+                _bulkPartial = false;
+            }
+        }
+        if (remaining > 0)
         {
-            // Message partiellement envoyé, stocker le reste
-            _messages.front() = message.substr(bytesSent);
+            // Message partiellement envoyé, garder le reste
+            IRC_PROBE3(send__partial, _fd, bytesSent, total);
+            _messages[lane].front().data.erase(0, remaining);
+            _bulkPartial = (lane == LANE_BULK);
             break;
         }
-        else
+        if (static_cast<size_t>(bytesSent) < total)
+        {
+            // Socket plein pile entre deux messages
+            break;
+        }
+    }
+}
+
+/**
+ * Récupère la taille de la file d'envoi
+ * return Nombre d'octets en attente d'envoi
+ */
+size_t Client::getSendQ() const
+{
+    return _sendQ;
+}
+
+/**
+ * Récupère la taille d'une voie de la file d'envoi
+ * arg lane Voie concernée
+ * return Nombre d'octets en attente dans cette voie
+ */
+size_t Client::getSendQ(OutputLane lane) const
+{
+    return _laneSendQ[lane];
+}
+
+/**
+ * Ajoute une réponse longue à émettre par morceaux
+ * arg stream Flux de réponse (le client en devient propriétaire)
+ */
+void Client::addStream(ReplyStream* stream)
+{
+    if (!stream)
+    {
+        return;
+    }
+    _streams.push(stream);
+
+    // Prévenir le serveur qu'il doit reprendre ce client à chaque tour
+    _server->scheduleStreams(this);
+}
+
+/**
+ * Vérifie si le client a des réponses longues en cours
+ * return true s'il reste des flux à émettre, false sinon
+ */
+bool Client::hasStreams() const
+{
+    return !_streams.empty();
+}
+
+/**
+ * Fait avancer les réponses longues tant que la file d'envoi est assez vide
+ * return true si tous les flux sont terminés, false sinon
+ */
+bool Client::pumpStreams()
+{
+    unsigned int budget = STREAM_LINES_PER_TURN;
+
+    while (!_streams.empty() && budget > 0 && _sendQ < STREAM_SENDQ_LOWAT)
+    {
+        // Un flux non terminé rend la main jusqu'au prochain tour de boucle
+        if (!_streams.front()->pump(this, budget))
         {
-            // Message complètement envoyé, le supprimer de la file
-            _messages.pop();
+            break;
         }
+        delete _streams.front();
+        _streams.pop();
     }
+    return _streams.empty();
+}
+
+/**
+ * Récupère l'heure de connexion du client
+ * return Heure de connexion
+ */
+time_t Client::getConnectTime() const
+{
+    return _connectTime;
+}
+
+/**
+ * Note une commande du client (PING et PONG ne comptent pas comme activité)
+ */
+void Client::recordActivity()
+{
+    _lastActive = time(NULL);
+}
+
+/**
+ * Retourne le temps d'inactivité affiché par WHOIS
+ * return Secondes depuis la dernière activité
+ */
+time_t Client::getIdleTime() const
+{
+    return time(NULL) - _lastActive;
+}
+
+unsigned long Client::getMessagesSent() const
+{
+    return _messagesSent;
+}
+
+unsigned long Client::getBytesSent() const
+{
+    return _bytesSent;
+}
+
+unsigned long Client::getMessagesReceived() const
+{
+    return _messagesReceived;
+}
+
+unsigned long Client::getBytesReceived() const
+{
+    return _bytesReceived;
+}
+
+/**
+ * Récupère la taille du buffer de réception
+ * return Nombre d'octets reçus mais pas encore traités
+ */
+size_t Client::getRecvQ() const
+{
+    return _buffer.size();
+}
+
+/**
+ * Comptabilise des octets reçus sur la connexion
+ * arg bytes Nombre d'octets reçus
+ */
+void Client::recordReceivedBytes(size_t bytes)
+{
+    _bytesReceived += bytes;
+    _lastRecvTime = Utils::getMonotonicMicros();
+}
+
+/**
+ * Récupère l'instant du dernier recv (horloge monotone)
+ * return Microsecondes
+ */
+uint64_t Client::getLastRecvTime() const
+{
+    return _lastRecvTime;
+}
+
+/**
+ * Comptabilise un message reçu sur la connexion
+ */
+void Client::recordReceivedMessage()
+{
+    _messagesReceived++;
+}
+
+/**
+ * Estime la mémoire occupée par le client (structure, chaînes, liste de canaux)
+ * return Nombre d'octets
+ */
+size_t Client::getMemoryUsage() const
+{
+    size_t bytes = sizeof(Client) + Utils::stringMemory(_nickname) + Utils::stringMemory(_username) +
+                   Utils::stringMemory(_hostname) + Utils::stringMemory(_realname) +
+                   Utils::stringMemory(_away_message) +
+                   _channels.capacity() * sizeof(Channel*);
+    for (size_t i = 0; i < _whoisChannels.size(); ++i)
+    {
+        bytes += sizeof(std::string) + Utils::stringMemory(_whoisChannels[i]);
+    }
+    bytes += (_monitored.capacity() - _monitored.size()) * sizeof(std::string);
+    for (size_t i = 0; i < _monitored.size(); ++i)
+    {
+        bytes += sizeof(std::string) + Utils::stringMemory(_monitored[i]);
+    }
+    return bytes;
+}
+
+/**
+ * Estime la mémoire occupée par le buffer de réception
+ * return Nombre d'octets
+ */
+size_t Client::getRecvQMemory() const
+{
+    return Utils::stringMemory(_buffer);
+}
+
+/**
+ * Estime la mémoire occupée par la file d'envoi
+ * return Nombre d'octets
+ */
+size_t Client::getSendQMemory() const
+{
+    return _sendQ + getSendQMessages() * (sizeof(OutgoingMessage) + 1);
+}
+
+/**
+ * Récupère le nombre de messages dans la file d'envoi
+ * return Nombre de messages
+ */
+size_t Client::getSendQMessages() const
+{
+    return _messages[LANE_PRIORITY].size() + _messages[LANE_BULK].size();
 }
 
 /**
@@ -463,6 +1168,207 @@ bool Client::isRegistered() const
     return _status == REGISTERED;
 }
 
+/**
+ * Échéance du timer du client: délai d'enregistrement ou keepalive
+ */
+void Client::onTimer()
+{
+    if (_status == DISCONNECTED)
+    {
+        return;
+    }
+
+    // Enregistrement non terminé dans le délai
+    if (_status != REGISTERED)
+    {
+        _server->recordRegistrationTimeout(_status == PASSWORD_SENT);
+        sendMessage("ERROR :Closing Link: " + _hostname + " (Registration timed out)");
+        setStatus(DISCONNECTED);
+        return;
+    }
+
+    uint64_t now = Utils::getMonotonicMicros();
+
+    // Un PING est en attente: toute donnée reçue depuis vaut réponse
+    if (_awaitingPong)
+    {
+        if (_lastRecvTime <= _pingSentAt)
+        {
+            _quitMessage = "Ping timeout: " + Utils::toString(PONG_TIMEOUT_MS / 1000) + " seconds";
+            sendMessage("ERROR :Closing Link: " + _hostname + " (" + _quitMessage + ")");
+            setStatus(DISCONNECTED);
+            return;
+        }
+        _awaitingPong = false;
+    }
+
+    // Connexion active récemment: réarmer pour le reste de l'intervalle
+    uint64_t idleMs = (now - _lastRecvTime) / 1000;
+    if (idleMs < KEEPALIVE_INTERVAL_MS)
+    {
+        _server->getTimerWheel().schedule(&_timer, KEEPALIVE_INTERVAL_MS - idleMs);
+        return;
+    }
+
+    // Connexion silencieuse: sonder le client
+    sendMessage("PING :" + _server->getServerName());
+    _awaitingPong = true;
+    _pingSentAt = now;
+    _server->getTimerWheel().schedule(&_timer, PONG_TIMEOUT_MS);
+}
+
+/**
+ * Enregistre la réception d'un PONG
+ */
+void Client::recordPong()
+{
+    _lastPong = Utils::getMonotonicMicros();
+    _awaitingPong = false;
+}
+
+/**
+ * Vérifie si le client échappe au contrôle de flood (opérateurs, bot, ports de confiance)
+ * return true si ses lignes ne sont jamais retenues, false sinon
+ */
+bool Client::isFloodExempt() const
+{
+    return _isOperator || _fd < 0 || (_listener && _listener->isTrusted());
+}
+
+/**
+ * Facture une commande à la pénalité du client
+ * arg cost Coût de la commande
+ * return 0 si la commande peut s'exécuter, sinon délai avant de réessayer (ms)
+ */
+uint64_t Client::chargeFlood(unsigned int cost)
+{
+    // Les commandes gratuites (PONG) ne sont jamais retenues, même au-delà du seuil
+    if (cost == 0 || isFloodExempt())
+    {
+        return 0;
+    }
+
+    // La pénalité redescend d'une milliseconde par milliseconde écoulée
+    uint64_t now = Utils::getMonotonicMicros() / 1000;
+    if (_floodTime < now)
+    {
+        _floodTime = now;
+    }
+    if (_floodTime - now > FLOOD_BURST_MS)
+    {
+        return _floodTime - now - FLOOD_BURST_MS;
+    }
+    _floodTime += static_cast<uint64_t>(cost) * FLOOD_PENALTY_MS;
+    return 0;
+}
+
+/**
+ * Ajoute une pénalité après coup, sans retenir la commande en cours (coût proportionnel
+ * au travail réellement fait: canaux rejoints ou quittés, échec d'OPER)
+ * arg cost Coût supplémentaire
+ */
+void Client::addFloodPenalty(unsigned int cost)
+{
+    if (cost == 0 || isFloodExempt())
+    {
+        return;
+    }
+    uint64_t now = Utils::getMonotonicMicros() / 1000;
+    if (_floodTime < now)
+    {
+        _floodTime = now;
+    }
+    _floodTime += static_cast<uint64_t>(cost) * FLOOD_PENALTY_MS;
+}
+
+/**
+ * Retient les lignes restantes et programme leur reprise
+ * arg delayMs Délai avant que la pénalité ne redescende sous le seuil
+ */
+void Client::deferLines(uint64_t delayMs)
+{
+    _floodDeferrals++;
+    if (!_floodTimer.isPending())
+    {
+        _server->getTimerWheel().schedule(&_floodTimer, delayMs);
+    }
+}
+
+/**
+ * Reprise des lignes retenues une fois la pénalité redescendue
+ */
+void Client::onFloodTimer()
+{
+    if (_status == DISCONNECTED || _runnable)
+    {
+        return;
+    }
+    _server->processClientBuffer(this);
+    processMessages();
+}
+
+unsigned long Client::getFloodDeferrals() const
+{
+    return _floodDeferrals;
+}
+
+/**
+ * Récupère la pénalité de flood en cours
+ * return Avance de l'horloge de pénalité sur l'heure actuelle (ms)
+ */
+uint64_t Client::getFloodPenalty() const
+{
+    uint64_t now = Utils::getMonotonicMicros() / 1000;
+    return _floodTime > now ? _floodTime - now : 0;
+}
+
+/**
+ * Vérifie si le client attend son tour avec des lignes complètes en buffer
+ * return true si le client est dans la file du serveur, false sinon
+ */
+bool Client::isRunnable() const
+{
+    return _runnable;
+}
+
+/**
+ * Marque le client comme présent ou non dans la file du serveur
+ * arg runnable true si le client attend son tour
+ */
+void Client::setRunnable(bool runnable)
+{
+    _runnable = runnable;
+}
+
+/**
+ * Vérifie si le client est dans la liste des connexions non enregistrées
+ * return true si le client y est, false sinon
+ */
+bool Client::isPending() const
+{
+    return _pending;
+}
+
+/**
+ * Mémorise la position du client dans la liste des connexions non enregistrées
+ * arg pending true si le client est dans la liste
+ * arg pos Position dans la liste (ignorée si pending est false)
+ */
+void Client::setPending(bool pending, std::list<Client*>::iterator pos)
+{
+    _pending = pending;
+    _pendingPos = pos;
+}
+
+/**
+ * Récupère la position du client dans la liste des connexions non enregistrées
+ * return Itérateur vers le client
+ */
+std::list<Client*>::iterator Client::getPendingPosition() const
+{
+    return _pendingPos;
+}
+
 /**
  * Définit si le client est absent
  * arg away true pour marquer comme absent, false sinon
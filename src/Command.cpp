@@ -4,6 +4,9 @@
 #include "../includes/Channel.hpp"
 #include "../includes/CommandHandler.hpp"
 #include "../includes/Utils.hpp"
+#include "../includes/Stats.hpp"
+#include "../includes/ListStream.hpp"
+#include "../includes/WhoStream.hpp"
 
 /**
  * Constructeur de la classe de base Command
@@ -16,7 +19,10 @@ Command::Command(Server* server, const std::string& name, bool requiresRegistrat
     : _server(server),               // Initialiser le pointeur vers le serveur
       _name(name),                   // Initialiser le nom de la commande
       _requiresRegistration(requiresRegistration), // Initialiser si la commande nécessite que le client soit enregistré
-      _minParams(minParams)          // Initialiser le nombre minimum de paramètres
+      _minParams(minParams),         // Initialiser le nombre minimum de paramètres
+      _useCount(0),                  // Aucune utilisation initialement
+      _useBytes(0),
+      _floodCost(1)                  // Coût standard d'une ligne
 {
     // vide
 }
@@ -56,6 +62,130 @@ unsigned int Command::getMinParams() const
     return _minParams;
 }
 
+/**
+ * Récupère le nombre d'utilisations de la commande
+ * return Nombre d'utilisations
+ */
+unsigned long Command::getUseCount() const
+{
+    return _useCount;
+}
+
+/**
+ * Récupère le nombre d'octets reçus pour la commande
+ * return Nombre d'octets
+ */
+unsigned long Command::getUseBytes() const
+{
+    return _useBytes;
+}
+
+/**
+ * Récupère le coût de la commande pour le contrôle de flood
+ * return Nombre de points de pénalité
+ */
+unsigned int Command::getFloodCost() const
+{
+    return _floodCost;
+}
+
+/**
+ * Comptabilise une utilisation de la commande
+ * arg bytes Taille de la ligne reçue
+ */
+void Command::recordUse(size_t bytes)
+{
+    _useCount++;
+    _useBytes += bytes;
+}
+
+/**
+ * Envoie un PRIVMSG ou un NOTICE à chaque cible d'une liste séparée par des virgules
+ * arg client Émetteur
+ * arg command "PRIVMSG" ou "NOTICE"
+ * arg targets Canaux et pseudos, au plus MAX_MESSAGE_TARGETS
+ * arg text Texte du message
+ * arg reportErrors false pour NOTICE: les cibles invalides sont ignorées en silence
+ */
+void Command::deliverMessage(Client* client, const std::string& command, const std::string& targets,
+                             const std::string& text, bool reportErrors)
+{
+    std::vector<std::string> names = Utils::split(targets, ',');
+    if (names.size() > MAX_MESSAGE_TARGETS)
+    {
+        if (reportErrors)
+        {
+            client->sendReply("407 " + client->getNickname() + " " + targets + " :Too many recipients (at most " +
+                              Utils::toString(MAX_MESSAGE_TARGETS) + ")");
+        }
+        return;
+    }
+    if (text.empty())
+    {
+        if (reportErrors)
+        {
+            client->sendReply("412 " + client->getNickname() + " :No text to send");
+        }
+        return;
+    }
+
+    // Préfixe et texte mis en forme une seule fois: seule la cible change d'une destination à l'autre
+    std::string head = ":" + client->getNickname() + "!" + client->getUsername() + "@" +
+                       client->getHostname() + " " + command + " ";
+    std::string tail = " :" + text;
+    std::string line;
+    std::set<std::string> seen;
+
+    for (size_t i = 0; i < names.size(); ++i)
+    {
+        const std::string& target = names[i];
+        // Une cible répétée ne reçoit qu'une copie
+        if (!seen.insert(Utils::toLower(target)).second)
+        {
+            continue;
+        }
+        line.reserve(head.size() + target.size() + tail.size());
+        line.assign(head);
+        line += target;
+        line += tail;
+
+        if (target[0] == '#' || target[0] == '&')
+        {
+            Channel* channel = _server->getChannel(target);
+            if (channel == NULL)
+            {
+                if (reportErrors)
+                    client->sendReply("403 " + target + " :No such channel");
+                continue;
+            }
+            if (!channel->hasClient(client))
+            {
+                if (reportErrors)
+                    client->sendReply("442 " + target + " :You're not on that channel");
+                continue;
+            }
+            channel->broadcast(line, client);
+            continue;
+        }
+
+        Client* targetClient = _server->getClientByNickname(target);
+        if (targetClient == NULL)
+        {
+            if (reportErrors)
+                client->sendReply("401 " + target + " :No such nick/channel");
+            continue;
+        }
+        targetClient->sendMessage(line, LANE_BULK);
+
+        // Réponse automatique si l'utilisateur est marqué comme absent
+        if (reportErrors && targetClient->isAway())
+        {
+            client->sendReply("301 " + target + " :" + targetClient->getAwayMessage());
+        }
+        Utils::logMessage("Client " + client->getNickname() + " a envoyé un " + command + " à " + target + ": " + text);
+    }
+}
+
 // Implémentation de la commande PASS
 
 /**
@@ -137,8 +267,8 @@ void NickCommand::execute(Client* client, const std::vector<std::string>& params
     // Récupérer l'ancien pseudo
     std::string oldNick = client->getNickname();
 
-    // Définir le nouveau pseudo
-    client->setNickname(newNick);
+    // Définir le nouveau pseudo (et mettre à jour l'index du serveur)
+    _server->renameClient(client, newNick);
 
     // Envoyer un message NICK si le client est déjà enregistré
     if (client->isRegistered())
@@ -148,14 +278,10 @@ void NickCommand::execute(Client* client, const std::vector<std::string>& params
         // Envoyer le message au client
         client->sendMessage(message);
 
-        // Diffuser le message à tous les canaux auxquels le client est connecté
-        std::vector<Channel*> channels = client->getChannels();
-        for (size_t i = 0; i < channels.size(); ++i)
-        {
-            channels[i]->broadcast(message, client);
-        }
+        // Une seule copie pour chaque membre d'un canal commun
+        _server->broadcastToPeers(client, message);
     }
-    else if (client->getStatus() == PASSWORD_SENT && !client->getUsername().empty())
+    else if (client->getStatus() == PASSWORD_SENT && !client->getUsername().empty() && !client->isNegotiatingCaps())
     {
         // Si le client a envoyé le mot de passe et son nom d'utilisateur, il est maintenant enregistré
         client->setStatus(REGISTERED);
@@ -174,36 +300,9 @@ void NickCommand::execute(Client* client, const std::vector<std::string>& params
  */
 void NickCommand::sendWelcomeMessages(Client* client)
 {
-    // Message de bienvenue
-    client->sendReply("001 :Welcome to the Internet Relay Network " + client->getNickname() + "!" + client->getUsername() + "@" + client->getHostname());
-
-    // Informations sur le serveur
-    client->sendReply("002 :Your host is " + _server->getServerName() + ", running version ft_irc 1.0");
-
-    // Date de création du serveur
-    client->sendReply("003 :This server was created " + _server->getCreationDate());
-
-    // Informations sur le serveur
-    client->sendReply("004 " + _server->getServerName() + " ft_irc 1.0 o o");
-
-    // Informations sur les utilisateurs
-    client->sendReply("251 :There are " + Utils::toString(_server->getClientCount()) + " users and 0 invisible on 1 servers");
-
-    // Informations sur les opérateurs
-    client->sendReply("252 0 :operator(s) online");
-
-    // Informations sur les canaux
-    client->sendReply("254 " + Utils::toString(_server->getChannelCount()) + " :channels formed");
-
-    // Informations sur les clients
-    client->sendReply("255 :I have " + Utils::toString(_server->getClientCount()) + " clients and 1 servers");
-
-    // Message du jour
-    client->sendReply("375 :- " + _server->getServerName() + " Message of the day - ");
-    client->sendReply("372 :- Welcome to ft_irc!");
-    client->sendReply("372 :- This server is running ft_irc 1.0");
-    client->sendReply("372 :- Have fun!");
-    client->sendReply("376 :End of /MOTD command");
+    // Rafale 001-376 pré-rendue: seuls le pseudo et les compteurs sont complétés, en un seul envoi
+    client->sendMessage(_server->getWelcome().renderBurst(client, _server->getClientCount(),
+                                                                _server->getOperatorCount(), _server->getChannelCount()));
 
     // Log d'enregistrement
     Utils::logMessage("Client " + client->getNickname() + " est maintenant enregistré");
@@ -250,7 +349,7 @@ void UserCommand::execute(Client* client, const std::vector<std::string>& params
 				realname += " " + params[i];
 			}
 		}
-		else if (realname.size() > 0 && realname[0] == ':')
+		else if (realname.empty() || realname[0] == ':')
 		{
 			realname = "Anonymous";
 		}
@@ -265,7 +364,7 @@ void UserCommand::execute(Client* client, const std::vector<std::string>& params
 	client->setRealname(realname);
 
 	// Si le client a envoyé le mot de passe et son pseudo, il est maintenant enregistré
-	if (client->getStatus() == PASSWORD_SENT && !client->getNickname().empty())
+	if (client->getStatus() == PASSWORD_SENT && !client->getNickname().empty() && !client->isNegotiatingCaps())
 	{
 		client->setStatus(REGISTERED);
 		NickCommand nickCmd(_server);
@@ -274,6 +373,97 @@ void UserCommand::execute(Client* client, const std::vector<std::string>& params
 	Utils::logMessage("Client " + Utils::toString(client->getFd()) + " a défini son nom d'utilisateur à " + username + " et son nom réel à " + realname);
 }
 
+// Implémentation de la commande CAP
+
+/**
+ * Constructeur de la commande CAP
+ * arg server Pointeur vers le serveur
+ */
+CapCommand::CapCommand(Server* server)
+    : Command(server, "CAP", false, 1) // CAP est utilisable avant l'enregistrement, et même avant PASS
+{
+    // vide
+}
+
+/**
+ * Exécute la commande CAP
+ * arg client Client qui exécute la commande
+ * arg params Sous-commande puis capacités demandées
+ */
+void CapCommand::execute(Client* client, const std::vector<std::string>& params)
+{
+    std::string subcommand = Utils::toUpper(params[0]);
+    std::string nick = client->getNickname().empty() ? "*" : client->getNickname();
+
+    if (subcommand == "LS" || subcommand == "LIST")
+    {
+        // Une négociation commencée avant l'enregistrement le suspend jusqu'à CAP END
+        if (!client->isRegistered())
+        {
+            client->setNegotiatingCaps(true);
+        }
+        std::string enabled;
+        if (client->hasCap(CAP_MULTI_PREFIX))
+            enabled += "multi-prefix";
+        if (client->hasCap(CAP_USERHOST_IN_NAMES))
+            enabled += std::string(enabled.empty() ? "" : " ") + "userhost-in-names";
+        client->sendReply("CAP " + nick + " " + subcommand + " :" + (subcommand == "LS" ? CAP_SUPPORTED : enabled));
+        return;
+    }
+
+    if (subcommand == "REQ")
+    {
+        if (!client->isRegistered())
+        {
+            client->setNegotiatingCaps(true);
+        }
+        // Liste en paramètre final (":a b"), ou en mots séparés chez les clients qui omettent le ':'
+        std::string request;
+        for (size_t i = 1; i < params.size(); ++i)
+        {
+            request += (i > 1 ? " " : "") + params[i];
+        }
+
+        // Tout ou rien: une seule capacité inconnue refuse toute la demande
+        unsigned int caps = client->getCaps();
+        std::vector<std::string> names = Utils::split(request, ' ');
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            bool remove = names[i][0] == '-';
+            std::string name = Utils::toLower(remove ? names[i].substr(1) : names[i]);
+            unsigned int cap = (name == "multi-prefix") ? CAP_MULTI_PREFIX :
+                               (name == "userhost-in-names") ? CAP_USERHOST_IN_NAMES : 0;
+            if (cap == 0)
+            {
+                client->sendReply("CAP " + nick + " NAK :" + request);
+                return;
+            }
+            caps = remove ? (caps & ~cap) : (caps | cap);
+        }
+        client->setCaps(caps);
+        client->sendReply("CAP " + nick + " ACK :" + request);
+        return;
+    }
+
+    if (subcommand == "END")
+    {
+        if (!client->isNegotiatingCaps())
+            return;
+        client->setNegotiatingCaps(false);
+        // NICK et USER reçus pendant la négociation: terminer l'enregistrement maintenant
+        if (client->getStatus() == PASSWORD_SENT && !client->getNickname().empty() &&
+            !client->getUsername().empty())
+        {
+            client->setStatus(REGISTERED);
+            NickCommand nickCmd(_server);
+            nickCmd.sendWelcomeMessages(client);
+        }
+        return;
+    }
+
+    client->sendReply("410 " + nick + " " + params[0] + " :Invalid CAP command");
+}
+
 // Implémentation de la commande QUIT
 
 /**
@@ -296,18 +486,11 @@ void QuitCommand::execute(Client* client, const std::vector<std::string>& params
     // Récupérer le message de départ
     std::string quitMessage = params.size() > 0 ? params[0] : "Quit";
 
-    // Marquer le client comme déconnecté
+    // Marquer le client comme déconnecté; le serveur annonce le QUIT aux membres des canaux communs
+    // en le fermant, une seule fois par membre
+    client->setQuitMessage("Quit: " + quitMessage);
     client->setStatus(DISCONNECTED);
 
-    // Envoyer un message QUIT à tous les canaux auxquels le client est connecté
-    std::string message = ":" + client->getNickname() + "!" + client->getUsername() + "@" + client->getHostname() + " QUIT :" + quitMessage;
-    std::vector<Channel*> channels = client->getChannels();
-
-    for (size_t i = 0; i < channels.size(); ++i)
-    {
-        channels[i]->broadcast(message, client);
-    }
-
     // Log de déconnexion
     Utils::logMessage("Client " + client->getNickname() + " s'est déconnecté: " + quitMessage);
 
@@ -323,28 +506,79 @@ void QuitCommand::execute(Client* client, const std::vector<std::string>& params
 JoinCommand::JoinCommand(Server* server)
     : Command(server, "JOIN", true, 1) // JOIN nécessite au moins 1 paramètre et nécessite que le client soit enregistré
 {
-    // vide
+    _floodCost = 2; // Par canal rejoint ou quitté: le premier à la lecture, les suivants après coup
 }
 
 /**
  * Exécute la commande JOIN
  * arg client Client qui exécute la commande
- * arg params Paramètres de la commande
+ * arg params Liste de canaux séparés par des virgules, puis leurs clés dans le même ordre (ou "0")
  */
 void JoinCommand::execute(Client* client, const std::vector<std::string>& params)
 {
-    // Récupérer le nom du canal
-    std::string channelName = params[0];
+    // JOIN 0: quitter tous les canaux
+    if (params[0] == "0")
+    {
+        partAll(client);
+        return;
+    }
+
+    std::vector<std::string> channels = Utils::split(params[0], ',');
+    if (channels.size() > MAX_JOIN_TARGETS)
+    {
+        client->sendReply("407 " + client->getNickname() + " " + params[0] + " :Too many channels (at most " +
+                          Utils::toString(MAX_JOIN_TARGETS) + ")");
+        return;
+    }
 
-    // Récupérer le mot de passe du canal (optionnel)
-    std::string password = params.size() > 1 ? params[1] : "";
+    // Les clés sont associées par position: une clé vide ("k1,,k3") laisse le canal sans clé
+    std::vector<std::string> keys;
+    if (params.size() > 1)
+    {
+        size_t start = 0;
+        size_t comma;
+        while ((comma = params[1].find(',', start)) != std::string::npos)
+        {
+            keys.push_back(params[1].substr(start, comma - start));
+            start = comma + 1;
+        }
+        keys.push_back(params[1].substr(start));
+    }
 
+    // Les réponses de tous les canaux (JOIN, sujet, membres) partent ensemble à la fin
+    unsigned int joined = 0;
+    client->cork();
+    for (size_t i = 0; i < channels.size(); ++i)
+    {
+        if (joinChannel(client, channels[i], i < keys.size() ? keys[i] : ""))
+        {
+            joined++;
+        }
+    }
+    client->uncork();
+
+    // La ligne a déjà été facturée pour un canal: les suivants coûtent autant chacun
+    if (joined > 1)
+    {
+        client->addFloodPenalty((joined - 1) * _floodCost);
+    }
+}
+
+/**
+ * Fait rejoindre un canal au client (création si le canal n'existe pas)
+ * arg client Client qui rejoint le canal
+ * arg channelName Nom du canal
+ * arg password Clé fournie pour ce canal (vide si aucune)
+ * return true si le client a rejoint le canal, false sinon
+ */
+bool JoinCommand::joinChannel(Client* client, const std::string& channelName, const std::string& password)
+{
     // Vérifier si le nom du canal est valide
     if (!Utils::isValidChannelName(channelName))
     {
         // Nom de canal invalide
         client->sendReply("403 " + channelName + " :No such channel");
-        return;
+        return false;
     }
 
     // Rechercher le canal
@@ -384,7 +618,7 @@ void JoinCommand::execute(Client* client, const std::vector<std::string>& params
                 // Autre raison
                 client->sendReply("474 " + channelName + " :Cannot join channel");
             }
-            return;
+            return false;
         }
 
         // Ajouter le client au canal
@@ -397,9 +631,11 @@ void JoinCommand::execute(Client* client, const std::vector<std::string>& params
         channel->removeInvite(client->getNickname());
     }
 
-    // Envoyer un message JOIN à tous les clients du canal
+    // Envoyer un message JOIN à tous les clients du canal; celui du client passe par la voie prioritaire
+    // pour précéder le sujet et la liste des membres
     std::string message = ":" + client->getNickname() + "!" + client->getUsername() + "@" + client->getHostname() + " JOIN :" + channelName;
-    channel->broadcast(message, NULL);
+    channel->broadcast(message, client);
+    client->sendMessage(message);
 
     // Envoyer le sujet du canal s'il existe
     if (!channel->getTopic().empty())
@@ -407,52 +643,45 @@ void JoinCommand::execute(Client* client, const std::vector<std::string>& params
         client->sendReply("332 " + client->getNickname() + " " + channelName + " :" + channel->getTopic());
     }
 
-    // Envoyer la liste des membres du canal
-    this->sendNames(client, channel);
+    // Envoyer la liste des membres du canal (lignes 353 en cache dans le canal)
+    channel->sendNames(client);
 
     // Log de rejointe de canal
     Utils::logMessage("Client " + client->getNickname() + " a rejoint le canal " + channelName);
+    return true;
 }
 
 /**
- * Envoie la liste des membres d'un canal à un client
- * arg client Client à qui envoyer la liste
- * arg channel Canal dont on envoie la liste des membres
+ * JOIN 0: fait quitter au client tous ses canaux, comme autant de PART
+ * arg client Client qui quitte ses canaux
  */
-void JoinCommand::sendNames(Client* client, Channel* channel)
+void JoinCommand::partAll(Client* client)
 {
-    // Récupérer la liste des clients du canal
-    std::vector<Client*> channelClients = channel->getClients();
+    std::string prefix = ":" + client->getNickname() + "!" + client->getUsername() + "@" + client->getHostname() + " PART ";
+    std::vector<Channel*> channels = client->getChannels();
 
-    // Construire la liste des membres
-    std::string names;
-    for (size_t i = 0; i < channelClients.size(); ++i)
+    client->cork();
+    for (size_t i = 0; i < channels.size(); ++i)
     {
-        // Ajouter @ devant le pseudo si le client est opérateur
-        if (channel->isOperator(channelClients[i]))
-        {
-            names += "@";
-        }
-        else if (channel->hasVoice(channelClients[i]))
-        {
-            names += "+";
-        }
-
-        // Ajouter le pseudo
-        names += channelClients[i]->getNickname();
-
-        // Ajouter un espace sauf pour le dernier client
-        if (i < channelClients.size() - 1)
+        std::string channelName = channels[i]->getName();
+        std::string message = prefix + channelName + " :Left all channels";
+        channels[i]->broadcast(message, client);
+        client->sendMessage(message);   // Voie prioritaire, dans l'ordre des numériques
+        channels[i]->removeClient(client);
+        if (channels[i]->getClientCount() == 0)
         {
-            names += " ";
+            _server->removeChannel(channelName);
         }
     }
+    client->uncork();
 
-    // Envoyer la liste des membres
-    client->sendReply("353 " + client->getNickname() + " = " + channel->getName() + " :" + names);
+    // Chaque canal quitté est facturé comme un JOIN: JOIN 0 ne doit pas rendre la bascule gratuite
+    if (channels.size() > 1)
+    {
+        client->addFloodPenalty(static_cast<unsigned int>(channels.size() - 1) * _floodCost);
+    }
 
-    // Envoyer la fin de la liste
-    client->sendReply("366 " + client->getNickname() + " " + channel->getName() + " :End of /NAMES list");
+    Utils::logMessage("Client " + client->getNickname() + " a quitté tous ses canaux (JOIN 0)");
 }
 
 // Implémentation de la commande PART
@@ -479,8 +708,6 @@ void PartCommand::execute(Client* client, const std::vector<std::string>& params
 
     // Récupérer le message de départ (optionnel)
     std::string partMessage = params.size() > 1 ? params[1] : "Leaving";
-	if(!partMessage.empty() && partMessage[0] == ':')
-		partMessage = partMessage.substr(1); // Enlever le ':' au début du message
 
     // Rechercher le canal
     Channel* channel = _server->getChannel(channelName);
@@ -499,9 +726,10 @@ void PartCommand::execute(Client* client, const std::vector<std::string>& params
         return;
     }
 
-    // Envoyer un message PART à tous les clients du canal
+    // Envoyer un message PART à tous les clients du canal; l'écho du client suit la voie de ses numériques
     std::string message = ":" + client->getNickname() + "!" + client->getUsername() + "@" + client->getHostname() + " PART " + channelName + " :" + partMessage;
-    channel->broadcast(message, NULL);
+    channel->broadcast(message, client);
+    client->sendMessage(message);
 
     // Supprimer le client du canal
     channel->removeClient(client);
@@ -535,67 +763,7 @@ PrivmsgCommand::PrivmsgCommand(Server* server)
  */
 void PrivmsgCommand::execute(Client* client, const std::vector<std::string>& params)
 {
-    // Récupérer la cible du message
-    std::string target = params[0];
-
-    // Récupérer le message
-    std::string message = params[1];
-
-    // Vérifier si la cible commence par #, c'est un canal
-    if (target[0] == '#' || target[0] == '&')
-    {
-        // Message à un canal
-        Channel* channel = _server->getChannel(target);
-
-        // Vérifier si le canal existe
-        if (channel == NULL)
-        {
-            // Canal inexistant
-            client->sendReply("403 " + target + " :No such channel");
-            return;
-        }
-
-        // Vérifier si le client est dans le canal
-        if (!channel->hasClient(client))
-        {
-            // Client pas dans le canal
-            client->sendReply("442 " + target + " :You're not on that channel");
-            return;
-        }
-
-        // Envoyer le message à tous les clients du canal sauf l'émetteur
-        std::string msg = ":" + client->getNickname() + "!" + client->getUsername() + "@" + client->getHostname() + " PRIVMSG " + target + " :" + message;
-        channel->broadcast(msg, client);
-
-        // Log de message à un canal
-        // Utils::logMessage("Client " + client->getNickname() + " a envoyé un message au canal " + target + message);
-    }
-    else
-    {
-        // Message à un utilisateur
-        Client* targetClient = _server->getClientByNickname(target);
-
-        // Vérifier si l'utilisateur existe
-        if (targetClient == NULL)
-        {
-            // Utilisateur inexistant
-            client->sendReply("401 " + target + " :No such nick/channel");
-            return;
-        }
-
-        // Envoyer le message à l'utilisateur
-        std::string msg = ":" + client->getNickname() + "!" + client->getUsername() + "@" + client->getHostname() + " PRIVMSG " + target + " :" + message;
-        targetClient->sendMessage(msg);
-
-        // Envoyer une réponse automatique si l'utilisateur est marqué comme absent
-        if (targetClient->isAway())
-        {
-            client->sendReply("301 " + target + " :" + targetClient->getAwayMessage());
-        }
-
-        // Log de message à un utilisateur
-        Utils::logMessage("Client " + client->getNickname() + " a envoyé un message à " + target + ": " + message);
-    }
+    deliverMessage(client, "PRIVMSG", params[0], params[1], true);
 }
 
 // Implémentation de la commande NOTICE
@@ -617,58 +785,8 @@ NoticeCommand::NoticeCommand(Server* server)
  */
 void NoticeCommand::execute(Client* client, const std::vector<std::string>& params)
 {
-    // Récupérer la cible de la notification
-    std::string target = params[0];
-
-    // Récupérer le message
-    std::string message = params[1];
-
-    // Vérifier si la cible commence par #, c'est un canal
-    if (target[0] == '#' || target[0] == '&')
-    {
-        // Notification à un canal
-        Channel* channel = _server->getChannel(target);
-
-        // Vérifier si le canal existe
-        if (channel == NULL)
-        {
-            // Canal inexistant, pas d'erreur pour NOTICE
-            return;
-        }
-
-        // Vérifier si le client est dans le canal
-        if (!channel->hasClient(client))
-        {
-            // Client pas dans le canal, pas d'erreur pour NOTICE
-            return;
-        }
-
-        // Envoyer la notification à tous les clients du canal sauf l'émetteur
-        std::string msg = ":" + client->getNickname() + "!" + client->getUsername() + "@" + client->getHostname() + " NOTICE " + target + " :" + message;
-        channel->broadcast(msg, client);
-
-        // Log de notification à un canal
-        Utils::logMessage("Client " + client->getNickname() + " a envoyé une notification au canal " + target + ": " + message);
-    }
-    else
-    {
-        // Notification à un utilisateur
-        Client* targetClient = _server->getClientByNickname(target);
-
-        // Vérifier si l'utilisateur existe
-        if (targetClient == NULL)
-        {
-            // Utilisateur inexistant, pas d'erreur pour NOTICE
-            return;
-        }
-
-        // Envoyer la notification à l'utilisateur
-        std::string msg = ":" + client->getNickname() + "!" + client->getUsername() + "@" + client->getHostname() + " NOTICE " + target + " :" + message;
-        targetClient->sendMessage(msg);
-
-        // Log de notification à un utilisateur
-        Utils::logMessage("Client " + client->getNickname() + " a envoyé une notification à " + target + ": " + message);
-    }
+    // Jamais de réponse d'erreur à un NOTICE (évite les boucles entre clients automatiques)
+    deliverMessage(client, "NOTICE", params[0], params[1], false);
 }
 
 // Implémentation de la commande MODE
@@ -717,6 +835,8 @@ if (modes.empty())
 std::string modeStr = "+";
 if (channel->hasMode(MODE_INVITE_ONLY)) modeStr += "i";
 if (channel->hasMode(MODE_TOPIC_LOCKED)) modeStr += "t";
+if (channel->hasMode(MODE_SECRET)) modeStr += "s";
+if (channel->hasMode(MODE_PRIVATE)) modeStr += "p";
 if (channel->hasMode(MODE_PASSWORD)) modeStr += "k";
 if (channel->hasMode(MODE_USER_LIMIT)) modeStr += "l";
 
@@ -769,6 +889,12 @@ else if (mode == 't')
 // Mode restriction du topic
 channel->setMode(MODE_TOPIC_LOCKED, add);
 modeChanges += "t";
+}
+else if (mode == 's' || mode == 'p')
+{
+// Canal secret ou privé: caché de LIST pour les non-membres
+channel->setMode(mode == 's' ? MODE_SECRET : MODE_PRIVATE, add);
+modeChanges += mode;
 }
  else if (mode == 'k')
 {
@@ -844,9 +970,9 @@ channel->setMode(MODE_USER_LIMIT, false);
 modeChanges += "l";
 }
 }
-else if (mode == 'o')
+else if (mode == 'o' || mode == 'v')
 {
-// Mode opérateur
+// Mode opérateur ou droit de parole
 if (paramIndex >= modeParams.size())
 {
 client->sendReply("461 MODE :Not enough parameters");
@@ -870,11 +996,14 @@ client->sendReply("441 " + modeParams[paramIndex] + " " + channelName + " :They
 continue;
 }
 
-// Définir/supprimer le statut d'opérateur
+// Définir/supprimer le statut d'opérateur ou le droit de parole
+if (mode == 'o')
 channel->setOperator(target, add);
+else
+channel->setVoice(target, add);
 
 // Ajouter au message MODE
-modeChanges += "o";
+modeChanges += mode;
 paramChanges += " " + modeParams[paramIndex];
 
 paramIndex++;
@@ -890,7 +1019,8 @@ client->sendReply("472 " + std::string(1, mode) + " :is unknown mode char to me"
 std::string message = ":" + client->getNickname() + "!" + client->getUsername() + "@" +
 client->getHostname() + " MODE " + channelName + " " +
 modeChanges + paramChanges;
-channel->broadcast(message, NULL);
+channel->broadcast(message, client);
+client->sendMessage(message); // L'auteur reçoit son écho avant les réponses qui suivent
 
 // Log de changement de mode
 Utils::logMessage("Modes du canal " + channelName + " changés par " + client->getNickname() +
@@ -1031,7 +1161,8 @@ channel->setTopic(newTopic, client);
 // Envoyer un message TOPIC à tous les clients du canal
 std::string message = ":" + client->getNickname() + "!" + client->getUsername() + "@" +
 client->getHostname() + " TOPIC " + channelName + " :" + newTopic;
-channel->broadcast(message, NULL);
+channel->broadcast(message, client);
+client->sendMessage(message);
 
 // Log de changement de sujet
 Utils::logMessage("Sujet du canal " + channelName + " changé par " + client->getNickname() +
@@ -1104,7 +1235,8 @@ return;
 std::string message = ":" + client->getNickname() + "!" + client->getUsername() + "@" +
 client->getHostname() + " KICK " + channelName + " " +
 targetNick + " :" + kickMessage;
-channel->broadcast(message, NULL);
+channel->broadcast(message, client);
+client->sendMessage(message);
 
 // Supprimer la cible du canal
 channel->removeClient(target);
@@ -1133,30 +1265,43 @@ void InviteCommand::execute(Client* client, const std::vector<std::string>& para
 NamesCommand::NamesCommand(Server* server)
 : Command(server, "NAMES", true, 0)
 {
-// vide
+_floodCost = 2; // Liste des membres
 }
 
 void NamesCommand::execute(Client* client, const std::vector<std::string>& params)
 {
-(void)client; // Pour éviter l'avertissement de paramètre non utilisé
-(void)params; // Pour éviter l'avertissement de paramètre non utilisé
+// Sans paramètre: pas de liste de tous les canaux, seulement la fin de liste
+if (params.empty())
+{
+client->sendReply("366 " + client->getNickname() + " * :End of /NAMES list");
+return;
+}
 
-// TODO: Implémenter NAMES
+std::vector<std::string> names = Utils::split(params[0], ',');
+for (size_t i = 0; i < names.size(); ++i)
+{
+Channel* channel = _server->getChannel(names[i]);
+// Canal inconnu, secret ou privé pour un non-membre: fin de liste vide
+if (channel == NULL || ((channel->hasMode(MODE_SECRET) || channel->hasMode(MODE_PRIVATE)) && !channel->hasClient(client)))
+{
+client->sendReply("366 " + client->getNickname() + " " + names[i] + " :End of /NAMES list");
+continue;
+}
+channel->sendNames(client);
+}
 }
 
 // Implémentation de la commande LIST
 ListCommand::ListCommand(Server* server)
 : Command(server, "LIST", true, 0)
 {
-// vide
+_floodCost = 3; // Parcours de tous les canaux
 }
 
 void ListCommand::execute(Client* client, const std::vector<std::string>& params)
 {
-(void)client; // Pour éviter l'avertissement de paramètre non utilisé
-(void)params; // Pour éviter l'avertissement de paramètre non utilisé
-
-// TODO: Implémenter LIST
+// Réponse produite par morceaux au rythme de la file d'envoi (masques et filtres ELIST dans params[0])
+client->addStream(new ListStream(_server, params.empty() ? "" : params[0]));
 }
 
 // Implémentation de la commande PING
@@ -1176,15 +1321,15 @@ client->sendMessage(":" + _server->getServerName() + " PONG " + _server->getServ
 PongCommand::PongCommand(Server* server)
 : Command(server, "PONG", false, 0)
 {
-// vide
+_floodCost = 0; // Réponse au PING du serveur, jamais retardée
 }
 
 void PongCommand::execute(Client* client, const std::vector<std::string>& params)
 {
-(void)client; // Pour éviter l'avertissement de paramètre non utilisé
 (void)params; // Pour éviter l'avertissement de paramètre non utilisé
 
-// Rien à faire, simplement marquer que le client a répondu
+// Marquer que le client a répondu au PING du serveur
+client->recordPong();
 }
 
 // Implémentation de la commande AWAY
@@ -1206,45 +1351,356 @@ void AwayCommand::execute(Client* client, const std::vector<std::string>& params
 WhoCommand::WhoCommand(Server* server)
 : Command(server, "WHO", true, 0)
 {
-// vide
+_floodCost = 3; // Recherche parmi tous les clients
 }
 
 void WhoCommand::execute(Client* client, const std::vector<std::string>& params)
 {
-(void)client; // Pour éviter l'avertissement de paramètre non utilisé
-(void)params; // Pour éviter l'avertissement de paramètre non utilisé
-
-// TODO: Implémenter WHO
+// Canal ou pseudo exact: parcours des membres ou de l'index; sinon masque sur tous les clients
+client->addStream(new WhoStream(_server, params.empty() ? "" : params[0], params.size() > 1 ? params[1] : ""));
 }
 
 // Implémentation de la commande WHOIS
 WhoisCommand::WhoisCommand(Server* server)
 : Command(server, "WHOIS", true, 1)
 {
-// vide
+_floodCost = 2; // Plusieurs numériques par cible
 }
 
 void WhoisCommand::execute(Client* client, const std::vector<std::string>& params)
 {
-(void)client; // Pour éviter l'avertissement de paramètre non utilisé
-(void)params; // Pour éviter l'avertissement de paramètre non utilisé
+// WHOIS [serveur] pseudo[,pseudo...]: un seul serveur, le premier paramètre est ignoré s'il y en a deux
+std::string targets = params.size() > 1 ? params[1] : params[0];
+std::string me = client->getNickname();
+std::vector<std::string> nicks = Utils::split(targets, ',');
+
+for (size_t i = 0; i < nicks.size(); ++i)
+{
+Client* target = _server->getClientByNickname(nicks[i]);
+if (target == NULL || !target->isRegistered())
+{
+client->sendReply("401 " + me + " " + nicks[i] + " :No such nick/channel");
+continue;
+}
+std::string nick = target->getNickname();
+
+client->sendReply("311 " + me + " " + nick + " " + target->getUsername() + " " + target->getHostname() +
+" * :" + target->getRealname());
+
+// Entrées 319 en cache; seuls les canaux secrets sont filtrés à chaque demande
+if (!target->hasSecretChannels())
+{
+client->sendReplyList("319 " + me + " " + nick + " :", target->getWhoisChannels(), ' ');
+}
+else
+{
+std::vector<std::string> entries = target->getWhoisChannels();
+std::vector<Channel*> channels = target->getChannels();
+for (size_t j = 0; j < channels.size(); ++j)
+{
+if (!channels[j]->hasMode(MODE_SECRET) ||
+(client != target && !client->isOperator() && !channels[j]->hasClient(client)))
+continue;
+entries.push_back((channels[j]->isOperator(target) ? "@" : (channels[j]->hasVoice(target) ? "+" : "")) +
+channels[j]->getName());
+}
+client->sendReplyList("319 " + me + " " + nick + " :", entries, ' ');
+}
+
+client->sendReply("312 " + me + " " + nick + " " + _server->getServerName() + " :ft_irc server");
+if (target->isOperator())
+client->sendReply("313 " + me + " " + nick + " :is an IRC operator");
+if (target->isAway())
+client->sendReply("301 " + me + " " + nick + " :" + target->getAwayMessage());
+client->sendReply("317 " + me + " " + nick + " " + Utils::sizeToString(static_cast<size_t>(target->getIdleTime())) +
+" " + Utils::sizeToString(static_cast<size_t>(target->getConnectTime())) + " :seconds idle, signon time");
+}
+client->sendReply("318 " + me + " " + targets + " :End of WHOIS list");
+}
+
+// Implémentation de la commande MOTD
+MotdCommand::MotdCommand(Server* server)
+: Command(server, "MOTD", true, 0)
+{
+}
 
-// TODO: Implémenter WHOIS
+void MotdCommand::execute(Client* client, const std::vector<std::string>& params)
+{
+(void)params; // Un seul serveur
+client->sendMessage(_server->getWelcome().renderMotd(client));
+}
+
+// Implémentation de la commande ISON
+IsonCommand::IsonCommand(Server* server)
+: Command(server, "ISON", true, 1)
+{
+}
+
+void IsonCommand::execute(Client* client, const std::vector<std::string>& params)
+{
+// Les pseudos peuvent être des paramètres séparés ou un dernier paramètre ":a b c"
+std::vector<std::string> online;
+for (size_t i = 0; i < params.size(); ++i)
+{
+std::vector<std::string> nicks = Utils::split(params[i], ' ');
+for (size_t j = 0; j < nicks.size(); ++j)
+{
+Client* target = _server->getClientByNickname(nicks[j]);
+if (target != NULL && target->isRegistered())
+online.push_back(target->getNickname());
+}
+}
+client->sendReplyList("303 " + client->getNickname() + " :", online, ' ', true);
+}
+
+// Implémentation de la commande USERHOST
+UserhostCommand::UserhostCommand(Server* server)
+: Command(server, "USERHOST", true, 1)
+{
+}
+
+void UserhostCommand::execute(Client* client, const std::vector<std::string>& params)
+{
+// Pas de limite à cinq pseudos: la réponse est coupée en plusieurs lignes 302 si besoin
+std::vector<std::string> replies;
+for (size_t i = 0; i < params.size(); ++i)
+{
+std::vector<std::string> nicks = Utils::split(params[i], ' ');
+for (size_t j = 0; j < nicks.size(); ++j)
+{
+Client* target = _server->getClientByNickname(nicks[j]);
+if (target == NULL || !target->isRegistered())
+continue;
+replies.push_back(target->getNickname() + (target->isOperator() ? "*" : "") + "=" +
+(target->isAway() ? "-" : "+") + target->getUsername() + "@" + target->getHostname());
+}
+}
+client->sendReplyList("302 " + client->getNickname() + " :", replies, ' ', true);
+}
+
+// Implémentation de la commande MONITOR
+MonitorCommand::MonitorCommand(Server* server)
+: Command(server, "MONITOR", true, 1)
+{
+}
+
+void MonitorCommand::execute(Client* client, const std::vector<std::string>& params)
+{
+std::string me = client->getNickname();
+std::string action = Utils::toUpper(params[0]);
+
+if (action == "+" || action == "-")
+{
+if (params.size() < 2)
+{
+client->sendReply("461 " + me + " MONITOR :Not enough parameters");
+return;
+}
+std::vector<std::string> nicks = Utils::split(params[1], ',');
+std::vector<std::string> added;
+for (size_t i = 0; i < nicks.size(); ++i)
+{
+std::string key = Utils::toLower(nicks[i]);
+if (action == "-")
+{
+_server->removeMonitor(client, key);
+continue;
+}
+if (!client->isMonitoring(key) && client->getMonitored().size() >= MONITOR_MAX_TARGETS)
+{
+// Les cibles restantes ne sont pas ajoutées; celles déjà acceptées sont tout de même annoncées
+std::string rest = nicks[i];
+for (size_t j = i + 1; j < nicks.size(); ++j)
+rest += "," + nicks[j];
+client->sendReply("734 " + me + " " + Utils::toString(MONITOR_MAX_TARGETS) + " " + rest +
+" :Monitor list is full.");
+break;
+}
+_server->addMonitor(client, key);
+added.push_back(key);
+}
+if (!added.empty())
+sendStatus(client, added);
+}
+else if (action == "C")
+{
+_server->clearMonitors(client);
+}
+else if (action == "L")
+{
+client->sendReplyList("732 " + me + " :", client->getMonitored(), ',');
+client->sendReply("733 " + me + " :End of MONITOR list");
+}
+else if (action == "S")
+{
+sendStatus(client, client->getMonitored());
+}
+}
+
+/**
+ * Envoie l'état actuel d'une liste de pseudos surveillés (730 présents, 731 absents)
+ * arg client Client qui surveille
+ * arg keys Pseudos en minuscules
+ */
+void MonitorCommand::sendStatus(Client* client, const std::vector<std::string>& keys)
+{
+std::vector<std::string> online;
+std::vector<std::string> offline;
+for (size_t i = 0; i < keys.size(); ++i)
+{
+Client* target = _server->getClientByNickname(keys[i]);
+if (target != NULL && target->isOnline())
+online.push_back(target->getNickname() + "!" + target->getUsername() + "@" + target->getHostname());
+else
+offline.push_back(keys[i]);
+}
+client->sendReplyList("730 " + client->getNickname() + " :", online, ',');
+client->sendReplyList("731 " + client->getNickname() + " :", offline, ',');
 }
 
 // Implémentation de la commande OPER
 OperCommand::OperCommand(Server* server)
 : Command(server, "OPER", true, 2)
 {
-// vide
+_floodCost = 2; // Comparaison de mot de passe; un échec coûte OPER_FAIL_PENALTY en plus
 }
 
 void OperCommand::execute(Client* client, const std::vector<std::string>& params)
 {
-(void)client; // Pour éviter l'avertissement de paramètre non utilisé
-(void)params; // Pour éviter l'avertissement de paramètre non utilisé
+// OPER <nom> <mot de passe>: comptes lus dans OPER_CONFIG_FILE au démarrage
+std::string nick = client->getNickname();
+if (!_server->checkOperator(params[0], params[1]))
+{
+client->sendReply("464 " + nick + " :Password incorrect");
+// Les essais suivants sont retenus par le contrôle de flood: pas de recherche du mot de passe au rythme normal
+client->addFloodPenalty(OPER_FAIL_PENALTY);
+Utils::logMessage("OPER refusé pour " + client->toString() + " (compte " + params[0] + ")", true);
+return;
+}
+if (!client->isOperator())
+{
+client->setOperator(true);
+client->sendMessage(":" + nick + " MODE " + nick + " :+o");
+}
+client->sendReply("381 " + nick + " :You are now an IRC operator");
+}
+
+// Implémentation de la commande STATS
+StatsCommand::StatsCommand(Server* server)
+: Command(server, "STATS", true, 0)
+{
+_floodCost = 3; // Rapports parcourant tout le serveur
+}
 
-// TODO: Implémenter OPER
+void StatsCommand::execute(Client* client, const std::vector<std::string>& params)
+{
+    // Sans lettre, il n'y a rien à rapporter
+    if (params.empty() || params[0].empty())
+    {
+        client->sendReply("219 " + client->getNickname() + " * :End of STATS report");
+        return;
+    }
+
+    // Connexions, adresses, mémoire, files et pénalités: réservé aux opérateurs
+    char letter = params[0][0];
+    if (std::string("lzitP").find(letter) != std::string::npos && !client->isOperator())
+    {
+        client->sendReply("481 " + client->getNickname() + " :Permission Denied- You're not an IRC operator");
+        client->sendReply("219 " + client->getNickname() + " " + std::string(1, letter) + " :End of STATS report");
+        return;
+    }
+    switch (letter)
+    {
+        case 'm':
+            // Utilisation des commandes
+            client->addStream(new StatsCommandsStream(_server));
+            break;
+        case 'l':
+            // Informations sur les connexions
+            client->addStream(new StatsLinksStream(_server));
+            break;
+        case 'z':
+            // Mémoire par sous-système
+            client->addStream(new StatsMemoryStream(_server));
+            break;
+        case 'u':
+        {
+            // Durée de fonctionnement du serveur et état de la boucle d'événements
+            long uptime = static_cast<long>(time(NULL) - _server->getStartTime());
+            char buffer[64];
+            snprintf(buffer, sizeof(buffer), "Server Up %ld days %ld:%02ld:%02ld",
+                     uptime / 86400, (uptime / 3600) % 24, (uptime / 60) % 60, uptime % 60);
+            client->sendReply("242 " + client->getNickname() + " :" + buffer);
+            client->sendReply("249 " + client->getNickname() + " :Event loop " + _server->getLoopMonitor().toString());
+            client->sendReply("219 " + client->getNickname() + " u :End of STATS report");
+            break;
+        }
+        case 't':
+        {
+            // Connexions non enregistrées, boucle d'acceptation et timers
+            const RegistrationStats& reg = _server->getRegistrationStats();
+            client->sendReply("249 " + client->getNickname() + " :Registration pending " +
+                              Utils::toString(_server->getPendingCount()));
+            client->sendReply("249 " + client->getNickname() + " :Registration timeouts CONNECTING " +
+                              Utils::sizeToString(reg.timedOutConnecting) + " PASSWORD_SENT " +
+                              Utils::sizeToString(reg.timedOutPassword));
+            client->sendReply("249 " + client->getNickname() + " :Registration reaped " +
+                              Utils::sizeToString(reg.reaped) + " buffer-exceeded " +
+                              Utils::sizeToString(reg.bufferExceeded));
+            AcceptStats acc = _server->getAcceptStats();
+            client->sendReply("249 " + client->getNickname() + " :Accept backlog " +
+                              Utils::toString(_server->getListenBacklog()) + " accepted " +
+                              Utils::sizeToString(acc.accepted) + " bursts " +
+                              Utils::sizeToString(acc.bursts) + " capped " +
+                              Utils::sizeToString(acc.capped) + " refused " +
+                              Utils::sizeToString(acc.refused) + " overflows " +
+                              Utils::sizeToString(acc.overflows) + " max-queue " +
+                              Utils::sizeToString(acc.maxQueue));
+            client->sendReply("249 " + client->getNickname() + " :Timers pending " +
+                              Utils::sizeToString(_server->getTimerWheel().getPending()) + " run queue " +
+                              Utils::toString(_server->getRunQueueLength()));
+            client->sendReply("219 " + client->getNickname() + " t :End of STATS report");
+            break;
+        }
+        case 'P':
+        {
+            // Sockets en écoute: options, classe et compteurs d'acceptation
+            const std::vector<Listener*>& listeners = _server->getListeners();
+            for (size_t i = 0; i < listeners.size(); ++i)
+            {
+                const Listener* listener = listeners[i];
+                const AcceptStats& acc = listener->getStats();
+                std::string max = listener->getMaxConnections() > 0 ? Utils::toString(listener->getMaxConnections()) : "-";
+                client->sendReply("249 " + client->getNickname() + " :Listener " + listener->toString() +
+                                  " class " + listener->getClassName() + " profile " +
+                                  listener->getProfile().name + " connections " +
+                                  Utils::toString(listener->getConnections()) + "/" + max + " backlog " +
+                                  Utils::toString(listener->getBacklog()) + " reuseport " +
+                                  (listener->getReusePort() ? "on" : "off") +
+                                  (listener->isTrusted() ? " trusted" : "") + " accepted " +
+                                  Utils::sizeToString(acc.accepted) + " refused " +
+                                  Utils::sizeToString(acc.refused) + " overflows " +
+                                  Utils::sizeToString(acc.overflows));
+            }
+            client->sendReply("219 " + client->getNickname() + " P :End of STATS report");
+            break;
+        }
+        case 'i':
+        {
+            // Contrôle d'admission: règles par préfixe et compteurs
+            std::vector<std::string> lines = _server->getAdmission().toLines();
+            for (size_t i = 0; i < lines.size(); ++i)
+            {
+                client->sendReply("249 " + client->getNickname() + " :" + lines[i]);
+            }
+            client->sendReply("219 " + client->getNickname() + " i :End of STATS report");
+            break;
+        }
+        default:
+            // Lettre inconnue: rapport vide
+            client->sendReply("219 " + client->getNickname() + " " + std::string(1, letter) + " :End of STATS report");
+            break;
+    }
 }
 
 // Implémentation de la commande FILE (bonus)
@@ -4,6 +4,8 @@
 #include "../includes/Channel.hpp"
 #include "../includes/Command.hpp"
 #include "../includes/Utils.hpp"
+#include "../includes/Probes.hpp"
+#include "../includes/MemoryReport.hpp"
 #include <iomanip>      // Pour std::setw et std::setfill
 
 /**
@@ -45,6 +47,7 @@ void CommandHandler::registerCommands()
     _commands["PASS"] = new PassCommand(_server);
     _commands["NICK"] = new NickCommand(_server);
     _commands["USER"] = new UserCommand(_server);
+    _commands["CAP"] = new CapCommand(_server);
 
     // Commandes de base
     _commands["QUIT"] = new QuitCommand(_server);
@@ -67,7 +70,12 @@ void CommandHandler::registerCommands()
     _commands["AWAY"] = new AwayCommand(_server);
     _commands["WHO"] = new WhoCommand(_server);
     _commands["WHOIS"] = new WhoisCommand(_server);
+    _commands["MOTD"] = new MotdCommand(_server);
+    _commands["ISON"] = new IsonCommand(_server);
+    _commands["USERHOST"] = new UserhostCommand(_server);
+    _commands["MONITOR"] = new MonitorCommand(_server);
     _commands["OPER"] = new OperCommand(_server);
+    _commands["STATS"] = new StatsCommand(_server);
 
     // Commandes bonus
     _commands["FILE"] = new FileCommand(_server);
@@ -97,18 +105,6 @@ std::vector<std::string> CommandHandler::parseParams(const std::string& paramsSt
 	}
 	while(pos < paramsStr.size())
 	{
-		// Si on trouve un caractère ':' au début d'un paramètre, tout le reste est un seul paramètre
-		if (paramsStr[pos] == ':')
-		{
-			std::string lastParam = paramsStr.substr(pos + 1);
-			if(!lastParam.empty())
-			{
-				params.push_back(lastParam);
-			}else{
-				params.push_back("");
-			}
-			break;
-		}
 		// Ignorer les espaces
 		while (pos < paramsStr.size() && isspace(paramsStr[pos]))
 		{
@@ -119,6 +115,13 @@ std::vector<std::string> CommandHandler::parseParams(const std::string& paramsSt
 		{
 			break;
 		}
+		// Si on trouve un caractère ':' au début d'un paramètre, tout le reste est un seul paramètre
+		// (testé après les espaces: sinon seul un ':' en tout début de ligne était reconnu)
+		if (paramsStr[pos] == ':')
+		{
+			params.push_back(paramsStr.substr(pos + 1));
+			break;
+		}
 		// Début du paramètre
 		size_t start = pos;
 		while (pos < paramsStr.size() && !isspace(paramsStr[pos]))
@@ -201,6 +204,7 @@ void CommandHandler::executeCommand(Client* client, const std::string& message)
 
 	// Récupérer la commande
 	Command* cmd = it->second;
+	cmd->recordUse(message.size());
 
 	// Vérifier si le client doit être enregistré pour utiliser cette commande
 	if (cmd->requiresRegistration() && !client->isRegistered())
@@ -211,7 +215,7 @@ void CommandHandler::executeCommand(Client* client, const std::string& message)
 	}
 
 	//verifier si le mdp est bon
-	if(cmdName != "PASS" && client->getStatus() == CONNECTING)
+	if(cmdName != "PASS" && cmdName != "CAP" && client->getStatus() == CONNECTING)
 	{
 		client->sendReply(formatReply(ERR_NOTREGISTERED, client, ":You have not provided a valid password"));
 		return;
@@ -228,8 +232,21 @@ void CommandHandler::executeCommand(Client* client, const std::string& message)
 		return;
 	}
 
-	// Exécuter la commande
+	// Le keepalive ne remet pas à zéro l'inactivité affichée par WHOIS
+	if(cmdName != "PING" && cmdName != "PONG")
+	{
+		client->recordActivity();
+	}
+
+	// Exécuter la commande (le client n'est jamais supprimé pendant l'exécution)
+	int clientFd = client->getFd();
+	uint64_t dispatchStart = IRC_PROBE_CLOCK(command__done);	// 0 sans outil attaché: pas de lecture d'horloge
+	IRC_PROBE2(command__dispatch, cmdName.c_str(), clientFd);
 	cmd->execute(client, parsedParams);
+	if(dispatchStart != 0)	// Outil attaché en cours de commande: durée inconnue, sonde sautée
+	{
+		IRC_PROBE3(command__done, cmdName.c_str(), clientFd, IRC_PROBE_CLOCK(command__done) - dispatchStart);
+	}
 }
 
 /**
@@ -348,4 +365,41 @@ bool CommandHandler::isValidNickname(const std::string& nickname)
 
 bool  CommandHandler::isCommandValid(const std::string& cmdName) const{
 	return _commands.find(cmdName) != _commands.end();
-}
\ No newline at end of file
+}
+
+/**
+ * Récupère le coût d'une commande pour le contrôle de flood
+ * arg cmdName Nom de la commande (en majuscules)
+ * return Coût de la commande, 1 pour une commande inconnue
+ */
+unsigned int CommandHandler::getFloodCost(const std::string& cmdName) const{
+	std::map<std::string, Command*>::const_iterator it = _commands.find(cmdName);
+	if (it == _commands.end())
+		return 1;
+	return it->second->getFloodCost();
+}
+
+/**
+ * Récupère la commande qui suit un nom dans l'ordre alphabétique
+ * arg name Nom de la dernière commande parcourue ("" pour commencer)
+ * return Commande suivante ou NULL à la fin
+ */
+Command* CommandHandler::getCommandAfter(const std::string& name) const{
+	std::map<std::string, Command*>::const_iterator it = _commands.upper_bound(name);
+	if (it == _commands.end())
+		return NULL;
+	return it->second;
+}
+
+/**
+ * Estime la mémoire occupée par la table des commandes
+ * return Nombre d'octets
+ */
+size_t CommandHandler::getMemoryUsage() const{
+	size_t bytes = sizeof(CommandHandler);
+	for (std::map<std::string, Command*>::const_iterator it = _commands.begin(); it != _commands.end(); ++it){
+		bytes += MEMORY_TREE_NODE_OVERHEAD + sizeof(std::map<std::string, Command*>::value_type) + sizeof(Command) +
+				Utils::stringMemory(it->first) + Utils::stringMemory(it->second->getName());
+	}
+	return bytes;
+}
@@ -1,5 +1,6 @@
 #include "../includes/FileTransfer.hpp"
 #include "../includes/Utils.hpp"
+#include "../includes/MemoryReport.hpp"
 #include <ctime>
 
 /**
@@ -176,4 +177,24 @@ void FileTransfer::cleanupCompletedTransfers()
 {
     // Implémentation minimale
     // Ne fait rien
-}
\ No newline at end of file
+}
+
+/**
+ * Estime la mémoire occupée par le gestionnaire et ses transferts en cours
+ * return Nombre d'octets
+ */
+size_t FileTransfer::getMemoryUsage() const
+{
+    size_t bytes = sizeof(FileTransfer) + Utils::stringMemory(_tempDir);
+
+    for (std::map<std::string, FileTransferInfo*>::const_iterator it = _transfers.begin(); it != _transfers.end(); ++it)
+    {
+        bytes += MEMORY_TREE_NODE_OVERHEAD + sizeof(std::string) + sizeof(FileTransferInfo*) + Utils::stringMemory(it->first);
+        if (it->second)
+        {
+            bytes += sizeof(FileTransferInfo) + Utils::stringMemory(it->second->filename) +
+                     Utils::stringMemory(it->second->tempFilePath) + Utils::stringMemory(it->second->transferId);
+        }
+    }
+    return bytes;
+}
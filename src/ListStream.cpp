@@ -0,0 +1,216 @@
+#include "../includes/ListStream.hpp"
+#include "../includes/Server.hpp"
+#include "../includes/Client.hpp"
+#include "../includes/Channel.hpp"
+#include "../includes/Utils.hpp"
+#include <cstdlib>      // Pour atol
+
+/**
+ * Constructeur du flux LIST
+ * arg server Pointeur vers le serveur
+ * arg query Premier paramètre de LIST: masques et filtres ELIST séparés par des virgules
+ */
+ListStream::ListStream(Server* server, const std::string& query)
+    : _server(server),
+      _nextName(0),
+      _cursor(""),
+      _started(false)
+{
+    _filter.minUsers = 0;
+    _filter.maxUsers = 0;
+    _filter.createdAfter = 0;
+    _filter.createdBefore = 0;
+    _filter.topicAfter = 0;
+    _filter.topicBefore = 0;
+
+    time_t now = time(NULL);
+    std::vector<std::string> tokens = Utils::split(query, ',');
+    bool literal = true;
+    for (size_t i = 0; i < tokens.size(); ++i)
+    {
+        if (parseFilter(tokens[i], _filter, now))
+        {
+            continue;
+        }
+        if (tokens[i][0] == '!' && tokens[i].size() > 1)
+        {
+            _filter.excludes.push_back(tokens[i].substr(1));
+            continue;
+        }
+        _filter.masks.push_back(tokens[i]);
+        literal = literal && !Utils::hasWildcards(tokens[i]);
+    }
+
+    // Des noms sans jokers se cherchent directement, sans parcourir la table
+    if (!_filter.masks.empty() && literal)
+    {
+        _names = _filter.masks;
+    }
+}
+
+/**
+ * Interprète un filtre ELIST (>n, <n, C<n, C>n, T<n, T>n; durées en minutes)
+ * arg token Élément de la requête
+ * arg filter Filtres à compléter
+ * arg now Heure de la requête
+ * return true si l'élément est un filtre, false si c'est un masque
+ */
+bool ListStream::parseFilter(const std::string& token, ListFilter& filter, time_t now)
+{
+    size_t start = (token[0] == 'C' || token[0] == 'c' || token[0] == 'T' || token[0] == 't') ? 1 : 0;
+    if (token.size() < start + 2 || (token[start] != '<' && token[start] != '>') ||
+        token.find_first_not_of("0123456789", start + 1) != std::string::npos)
+    {
+        return false;
+    }
+    bool less = token[start] == '<';
+    long value = atol(token.c_str() + start + 1);
+
+    if (start == 0)
+    {
+        if (less)
+        {
+            filter.maxUsers = value;
+        }
+        else
+        {
+            filter.minUsers = value;
+        }
+        return true;
+    }
+
+    // "Il y a moins de n minutes" = après now - n minutes
+    time_t limit = now - value * 60;
+    bool creation = (token[0] == 'C' || token[0] == 'c');
+    if (creation)
+    {
+        (less ? filter.createdAfter : filter.createdBefore) = limit;
+    }
+    else
+    {
+        (less ? filter.topicAfter : filter.topicBefore) = limit;
+    }
+    return true;
+}
+
+/**
+ * Vérifie si un canal doit figurer dans la réponse
+ * arg client Client qui a demandé la liste
+ * arg channel Canal examiné
+ * return true si le canal passe tous les filtres
+ */
+bool ListStream::matches(Client* client, Channel* channel) const
+{
+    // Secret ou privé: un test de bits écarte le canal avant toute autre vérification
+    if ((channel->getModes() & (MODE_SECRET | MODE_PRIVATE)) && !channel->hasClient(client))
+    {
+        return false;
+    }
+
+    unsigned int users = channel->getClientCount();
+    if ((_filter.minUsers && users <= _filter.minUsers) || (_filter.maxUsers && users >= _filter.maxUsers))
+    {
+        return false;
+    }
+    time_t created = channel->getCreationTime();
+    if ((_filter.createdAfter && created <= _filter.createdAfter) ||
+        (_filter.createdBefore && created >= _filter.createdBefore))
+    {
+        return false;
+    }
+    if (_filter.topicAfter || _filter.topicBefore)
+    {
+        time_t topicTime = channel->getTopicTime();
+        if (topicTime == 0 || (_filter.topicAfter && topicTime <= _filter.topicAfter) ||
+            (_filter.topicBefore && topicTime >= _filter.topicBefore))
+        {
+            return false;
+        }
+    }
+
+    // Les noms exacts ont déjà été choisis par la recherche directe
+    if (_names.empty() && !_filter.masks.empty())
+    {
+        bool found = false;
+        for (size_t i = 0; i < _filter.masks.size() && !found; ++i)
+        {
+            found = Utils::matchMask(_filter.masks[i], channel->getName());
+        }
+        if (!found)
+        {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < _filter.excludes.size(); ++i)
+    {
+        if (Utils::matchMask(_filter.excludes[i], channel->getName()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Avance au canal suivant (nom demandé ou entrée suivante de la table)
+ * return Canal suivant, ou NULL quand le parcours est terminé
+ */
+Channel* ListStream::next()
+{
+    if (!_names.empty())
+    {
+        while (_nextName < _names.size())
+        {
+            Channel* channel = _server->getChannel(_names[_nextName++]);
+            if (channel)
+            {
+                return channel;
+            }
+        }
+        return NULL;
+    }
+
+    Channel* channel = _server->getChannelAfter(_cursor);
+    if (channel)
+    {
+        _cursor = Utils::toLower(channel->getName());
+    }
+    return channel;
+}
+
+/**
+ * Émet les lignes RPL_LIST des canaux qui passent les filtres
+ * arg client Client qui a demandé la liste
+ * arg budget Nombre de lignes encore autorisées pour ce tour
+ * return true quand tous les canaux ont été examinés
+ */
+bool ListStream::pump(Client* client, unsigned int& budget)
+{
+    if (!_started)
+    {
+        client->sendReply("321 " + client->getNickname() + " Channel :Users  Name");
+        _started = true;
+    }
+
+    // Le nombre de canaux examinés est borné aussi: des filtres sélectifs ne bloquent pas la boucle
+    unsigned int scanned = 0;
+    while (budget > 0 && scanned < LIST_SCAN_PER_TURN)
+    {
+        Channel* channel = next();
+        if (channel == NULL)
+        {
+            client->sendReply("323 " + client->getNickname() + " :End of /LIST");
+            return true;
+        }
+        scanned++;
+
+        if (!matches(client, channel))
+        {
+            continue;
+        }
+        client->sendReply("322 " + client->getNickname() + " " + channel->getName() + " " +
+                          Utils::toString(channel->getClientCount()) + " :" + channel->getTopic());
+        budget--;
+    }
+    return false;
+}
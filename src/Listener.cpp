@@ -0,0 +1,615 @@
+#include "../includes/Listener.hpp"
+#include "../includes/Utils.hpp"
+#include <unistd.h>      // Pour close
+#include <cstring>       // Pour memset et strerror
+#include <cerrno>        // Pour errno
+#include <stdexcept>     // Pour std::runtime_error
+#include <cstdlib>       // Pour atoi
+#include <vector>        // Pour découper keepalive=idle/intervalle/sondes
+#include <netinet/in.h>  // Pour sockaddr_in et sockaddr_in6
+#include <netinet/tcp.h> // Pour TCP_INFO et les options TCP des profils
+#include <arpa/inet.h>   // Pour inet_pton
+#include <sys/un.h>      // Pour sockaddr_un
+#include <sys/stat.h>    // Pour lstat et chmod
+
+/**
+ * Constructeur de la classe Listener (socket non ouvert)
+ * arg address Adresse d'écoute ("::" pour la double pile, "0.0.0.0" pour IPv4 seul)
+ * arg port Port d'écoute
+ * arg backlog File d'attente demandée à listen
+ * arg reusePort Activer SO_REUSEPORT
+ * arg className Classe des connexions reçues
+ * arg maxConnections Connexions simultanées permises (0 = limite globale seule)
+ */
+Listener::Listener(const std::string& address, int port, int backlog, bool reusePort,
+                   const std::string& className, unsigned int maxConnections)
+    : _address(address),
+      _port(port),
+      _unix(false),
+      _mode(LISTENER_UNIX_MODE),
+      _trusted(false),
+      _backlog(backlog),
+      _reusePort(reusePort),
+      _className(className),
+      _maxConnections(maxConnections),
+      _fd(-1),
+      _connections(0)
+{
+    memset(&_stats, 0, sizeof(_stats));
+    setProfile("default");
+}
+
+/**
+ * Destructeur de la classe Listener
+ */
+Listener::~Listener()
+{
+    close();
+}
+
+/**
+ * Fait de ce port un socket Unix (l'adresse est alors un chemin)
+ * arg mode Permissions du fichier de socket
+ */
+void Listener::setUnix(unsigned int mode)
+{
+    _unix = true;
+    _mode = mode;
+    _port = 0;
+}
+
+/**
+ * Marque les connexions reçues comme exemptées du contrôle de flood
+ * arg trusted true pour les robots et outils de charge locaux
+ */
+void Listener::setTrusted(bool trusted)
+{
+    _trusted = trusted;
+}
+
+/**
+ * Remplace les réglages des sockets par un profil prédéfini
+ * arg name default (noyau), lowlatency (humains) ou bulk (liens serveur, transferts)
+ * return true si le profil existe, false sinon
+ */
+bool Listener::setProfile(const std::string& name)
+{
+    SocketProfile profile;
+    profile.name = name;
+    profile.noDelay = false;
+    profile.sndBuf = 0;
+    profile.rcvBuf = 0;
+    profile.keepIdle = 0;
+    profile.keepInterval = 0;
+    profile.keepCount = 0;
+    profile.userTimeout = 0;
+    profile.notSentLowat = 0;
+
+    if (name == "lowlatency")
+    {
+        // Petites lignes interactives: envoi immédiat, et peu de données figées dans le noyau
+        // pour que la voie prioritaire de la file d'envoi passe devant la diffusion
+        profile.noDelay = true;
+        profile.keepIdle = 60;
+        profile.keepInterval = 15;
+        profile.keepCount = 4;
+        profile.userTimeout = 60000;
+        profile.notSentLowat = 16384;
+    }
+    else if (name == "bulk")
+    {
+        // Débit avant latence: gros tampons, sondes espacées
+        profile.sndBuf = 1048576;
+        profile.rcvBuf = 1048576;
+        profile.keepIdle = 300;
+        profile.keepInterval = 60;
+        profile.keepCount = 5;
+        profile.userTimeout = 300000;
+    }
+    else if (name != "default")
+    {
+        return false;
+    }
+    _profile = profile;
+    return true;
+}
+
+/**
+ * Ajuste un réglage du profil
+ * arg option profile=<nom>, nodelay, sndbuf=N, rcvbuf=N, keepalive=idle/intervalle/sondes,
+ *            user_timeout=ms ou notsent_lowat=N
+ * return true si l'option est reconnue et valide, false sinon
+ */
+bool Listener::setSocketOption(const std::string& option)
+{
+    size_t equal = option.find('=');
+    std::string key = option.substr(0, equal);
+    std::string value = equal == std::string::npos ? "" : option.substr(equal + 1);
+    int number = atoi(value.c_str());
+
+    if (key == "profile")
+    {
+        return setProfile(value);
+    }
+    if (key == "nodelay" && value.empty())
+    {
+        _profile.noDelay = true;
+        return true;
+    }
+    if (value.empty() || number < 0)
+    {
+        return false;
+    }
+    if (key == "sndbuf")
+    {
+        _profile.sndBuf = number;
+    }
+    else if (key == "rcvbuf")
+    {
+        _profile.rcvBuf = number;
+    }
+    else if (key == "user_timeout")
+    {
+        _profile.userTimeout = number;
+    }
+    else if (key == "notsent_lowat")
+    {
+        _profile.notSentLowat = number;
+    }
+    else if (key == "keepalive")
+    {
+        std::vector<std::string> parts = Utils::split(value, '/');
+        if (parts.size() != 3)
+        {
+            return false;
+        }
+        _profile.keepIdle = atoi(parts[0].c_str());
+        _profile.keepInterval = atoi(parts[1].c_str());
+        _profile.keepCount = atoi(parts[2].c_str());
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Récupère le profil de réglage des sockets
+ * return Profil appliqué à l'acceptation
+ */
+const SocketProfile& Listener::getProfile() const
+{
+    return _profile;
+}
+
+/**
+ * Crée, lie et met en écoute le socket
+ * arg somaxconn Taille maximum de la file d'attente permise par le noyau (0 = inconnue)
+ */
+void Listener::open(int somaxconn)
+{
+    struct sockaddr_storage storage;
+    socklen_t length;
+    memset(&storage, 0, sizeof(storage));
+
+    struct sockaddr_in6* in6 = reinterpret_cast<struct sockaddr_in6*>(&storage);
+    struct sockaddr_in* in = reinterpret_cast<struct sockaddr_in*>(&storage);
+    struct sockaddr_un* un = reinterpret_cast<struct sockaddr_un*>(&storage);
+    if (_unix)
+    {
+        if (_address.empty() || _address.size() >= sizeof(un->sun_path))
+        {
+            throw std::runtime_error("Chemin de socket Unix invalide: " + _address);
+        }
+        // Un socket laissé par une exécution précédente empêcherait bind; ne supprimer que des sockets
+        struct stat st;
+        if (lstat(_address.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+        {
+            unlink(_address.c_str());
+        }
+        un->sun_family = AF_UNIX;
+        memcpy(un->sun_path, _address.c_str(), _address.size());
+        length = sizeof(*un);
+    }
+    else if (inet_pton(AF_INET6, _address.c_str(), &in6->sin6_addr) == 1)
+    {
+        in6->sin6_family = AF_INET6;
+        in6->sin6_port = htons(_port);
+        length = sizeof(*in6);
+    }
+    else if (inet_pton(AF_INET, _address.c_str(), &in->sin_addr) == 1)
+    {
+        in->sin_family = AF_INET;
+        in->sin_port = htons(_port);
+        length = sizeof(*in);
+    }
+    else
+    {
+        throw std::runtime_error("Adresse d'écoute invalide: " + _address);
+    }
+
+    _fd = socket(storage.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (_fd < 0 && errno == EAFNOSUPPORT && _address == "::")
+    {
+        // Noyau sans IPv6: se replier sur toutes les adresses IPv4
+        Utils::logMessage("IPv6 indisponible, écoute en IPv4 sur le port " + Utils::toString(_port), true);
+        _address = "0.0.0.0";
+        open(somaxconn);
+        return;
+    }
+    if (_fd < 0)
+    {
+        throw std::runtime_error("Erreur lors de la creation du socket serveur: " + std::string(strerror(errno)));
+    }
+
+    int opt = 1;
+    if ((!_unix && setsockopt(_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) ||
+        (_reusePort && setsockopt(_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0))
+    {
+        int error = errno;
+        close();
+        throw std::runtime_error("Erreur lors de la configuration du socket serveur: " + std::string(strerror(error)));
+    }
+
+    // Double pile: les clients IPv4 arrivent en ::ffff:a.b.c.d sur le même socket
+    if (storage.ss_family == AF_INET6)
+    {
+        int v6only = 0;
+        setsockopt(_fd, IPPROTO_IPV6, IPV6_V6ONLY, &v6only, sizeof(v6only));
+    }
+
+    if (bind(_fd, reinterpret_cast<struct sockaddr*>(&storage), length) < 0)
+    {
+        int error = errno;
+        close();
+        throw std::runtime_error("Erreur lors de la liaison du socket serveur " + toString() + ": " + std::string(strerror(error)));
+    }
+    if (_unix && chmod(_address.c_str(), _mode) < 0)
+    {
+        Utils::logMessage("Impossible de changer les permissions de " + _address + ": " + std::string(strerror(errno)), true);
+    }
+
+    // Le noyau tronque silencieusement la file à somaxconn: garder la valeur réelle
+    if (somaxconn > 0 && _backlog > somaxconn)
+    {
+        Utils::logMessage("File d'attente de " + toString() + " ramenée de " + Utils::toString(_backlog) +
+                          " à somaxconn (" + Utils::toString(somaxconn) + ")", true);
+        _backlog = somaxconn;
+    }
+    if (listen(_fd, _backlog) < 0)
+    {
+        int error = errno;
+        close();
+        throw std::runtime_error("Erreur lors de l'écoute du socket serveur " + toString() + ": " + std::string(strerror(error)));
+    }
+
+    Utils::logMessage("Écoute sur " + toString() + " (classe " + _className + ", profil " + _profile.name + ", file d'attente " +
+                      Utils::toString(_backlog) + (_reusePort ? ", SO_REUSEPORT" : "") +
+                      (_trusted ? ", sans contrôle de flood)" : ")"));
+}
+
+/**
+ * Ferme le socket en écoute
+ */
+void Listener::close()
+{
+    if (_fd != -1)
+    {
+        ::close(_fd);
+        _fd = -1;
+        // Le fichier du socket Unix n'est plus utile une fois le port fermé
+        if (_unix)
+        {
+            unlink(_address.c_str());
+        }
+    }
+}
+
+/**
+ * Applique le profil à un socket accepté (seuls les tampons concernent un socket Unix)
+ * arg clientFd Socket accepté
+ */
+void Listener::tune(int clientFd) const
+{
+    int failures = 0;
+    int on = 1;
+
+    if (_profile.sndBuf > 0)
+    {
+        failures += setsockopt(clientFd, SOL_SOCKET, SO_SNDBUF, &_profile.sndBuf, sizeof(int)) < 0;
+    }
+    if (_profile.rcvBuf > 0)
+    {
+        failures += setsockopt(clientFd, SOL_SOCKET, SO_RCVBUF, &_profile.rcvBuf, sizeof(int)) < 0;
+    }
+    if (_unix)
+    {
+        return;
+    }
+    if (_profile.noDelay)
+    {
+        failures += setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on)) < 0;
+    }
+    if (_profile.keepIdle > 0)
+    {
+        failures += setsockopt(clientFd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on)) < 0;
+        failures += setsockopt(clientFd, IPPROTO_TCP, TCP_KEEPIDLE, &_profile.keepIdle, sizeof(int)) < 0;
+        if (_profile.keepInterval > 0)
+        {
+            failures += setsockopt(clientFd, IPPROTO_TCP, TCP_KEEPINTVL, &_profile.keepInterval, sizeof(int)) < 0;
+        }
+        if (_profile.keepCount > 0)
+        {
+            failures += setsockopt(clientFd, IPPROTO_TCP, TCP_KEEPCNT, &_profile.keepCount, sizeof(int)) < 0;
+        }
+    }
+    if (_profile.userTimeout > 0)
+    {
+        failures += setsockopt(clientFd, IPPROTO_TCP, TCP_USER_TIMEOUT, &_profile.userTimeout, sizeof(int)) < 0;
+    }
+    if (_profile.notSentLowat > 0)
+    {
+        failures += setsockopt(clientFd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &_profile.notSentLowat, sizeof(int)) < 0;
+    }
+    if (failures > 0)
+    {
+        Utils::logMessage("Profil " + _profile.name + ": " + Utils::toString(failures) + " réglage(s) refusé(s) par le noyau sur le fd " +
+                          Utils::toString(clientFd), true);
+    }
+}
+
+/**
+ * Relit les réglages effectifs d'un socket (le noyau double SO_SNDBUF/SO_RCVBUF)
+ * arg fd Socket du client
+ * arg tcp false pour un socket Unix (pas d'options TCP)
+ * return Réglages au format nodelay=1 sndbuf=N ...
+ */
+std::string Listener::describeSocket(int fd, bool tcp)
+{
+    int value = 0;
+    socklen_t length = sizeof(value);
+    std::string text;
+
+    if (getsockopt(fd, SOL_SOCKET, SO_SNDBUF, &value, &length) == 0)
+    {
+        text += "sndbuf=" + Utils::toString(value);
+    }
+    length = sizeof(value);
+    if (getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &value, &length) == 0)
+    {
+        text += " rcvbuf=" + Utils::toString(value);
+    }
+    if (!tcp)
+    {
+        return text;
+    }
+
+    int keepAlive = 0;
+    int idle = 0;
+    int interval = 0;
+    int count = 0;
+    length = sizeof(value);
+    if (getsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &value, &length) == 0)
+    {
+        text += std::string(" nodelay=") + (value ? "1" : "0");
+    }
+    length = sizeof(keepAlive);
+    getsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &keepAlive, &length);
+    if (keepAlive)
+    {
+        length = sizeof(idle);
+        getsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, &length);
+        length = sizeof(interval);
+        getsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &interval, &length);
+        length = sizeof(count);
+        getsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &count, &length);
+        text += " keepalive=" + Utils::toString(idle) + "/" + Utils::toString(interval) + "/" + Utils::toString(count);
+    }
+    else
+    {
+        text += " keepalive=off";
+    }
+    length = sizeof(value);
+    if (getsockopt(fd, IPPROTO_TCP, TCP_USER_TIMEOUT, &value, &length) == 0)
+    {
+        text += " user_timeout=" + Utils::toString(value);
+    }
+    length = sizeof(value);
+    if (getsockopt(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT, &value, &length) == 0)
+    {
+        text += " notsent_lowat=" + Utils::toString(value);
+    }
+    return text;
+}
+
+/**
+ * Identifie le processus à l'autre bout d'un socket Unix (SO_PEERCRED)
+ * arg clientFd Connexion acceptée sur un socket Unix
+ * return Nom d'hôte dérivé de l'utilisateur du pair (uid-1000.unix), "unix" si inconnu
+ */
+std::string Listener::peerIdentity(int clientFd)
+{
+    struct ucred cred;
+    socklen_t length = sizeof(cred);
+    if (getsockopt(clientFd, SOL_SOCKET, SO_PEERCRED, &cred, &length) < 0)
+    {
+        return "unix";
+    }
+    Utils::logMessage("Pair local: pid " + Utils::toString(cred.pid) + " uid " + Utils::toString(cred.uid) +
+                      " gid " + Utils::toString(cred.gid));
+    return "uid-" + Utils::toString(cred.uid) + ".unix";
+}
+
+/**
+ * Vérifie si ce port a atteint sa limite de connexions
+ * return true si une nouvelle connexion doit être refusée
+ */
+bool Listener::isFull() const
+{
+    return _maxConnections > 0 && _connections >= _maxConnections;
+}
+
+/**
+ * Compte une connexion ouverte reçue par ce port
+ */
+void Listener::addConnection()
+{
+    _connections++;
+}
+
+/**
+ * Décompte une connexion fermée
+ */
+void Listener::removeConnection()
+{
+    if (_connections > 0)
+    {
+        _connections--;
+    }
+}
+
+/**
+ * Relève l'occupation de la file d'attente du noyau avant de la vider
+ */
+void Listener::sampleQueue()
+{
+    if (_unix)
+    {
+        return;     // Pas de TCP_INFO sur un socket Unix
+    }
+
+    // Sur un socket en écoute, TCP_INFO donne la file courante (unacked) et sa taille maximum (sacked)
+    struct tcp_info info;
+    socklen_t length = sizeof(info);
+    memset(&info, 0, sizeof(info));
+    if (getsockopt(_fd, IPPROTO_TCP, TCP_INFO, &info, &length) < 0)
+    {
+        return;
+    }
+    if (info.tcpi_unacked > _stats.maxQueue)
+    {
+        _stats.maxQueue = info.tcpi_unacked;
+    }
+    // File pleine: le noyau a commencé à ignorer les SYN
+    if (info.tcpi_sacked > 0 && info.tcpi_unacked >= info.tcpi_sacked)
+    {
+        _stats.overflows++;
+    }
+}
+
+/**
+ * Récupère les compteurs d'acceptation
+ * return Compteurs modifiables par la boucle d'acceptation
+ */
+AcceptStats& Listener::getStats()
+{
+    return _stats;
+}
+
+/**
+ * Récupère les compteurs d'acceptation
+ * return Compteurs
+ */
+const AcceptStats& Listener::getStats() const
+{
+    return _stats;
+}
+
+/**
+ * Récupère le socket en écoute
+ * return Descripteur de fichier (-1 si fermé)
+ */
+int Listener::getFd() const
+{
+    return _fd;
+}
+
+/**
+ * Récupère le port d'écoute
+ * return Port
+ */
+int Listener::getPort() const
+{
+    return _port;
+}
+
+/**
+ * Récupère la file d'attente effective
+ * return Taille de la file passée à listen
+ */
+int Listener::getBacklog() const
+{
+    return _backlog;
+}
+
+/**
+ * Indique si SO_REUSEPORT est activé
+ * return true si le port peut être partagé
+ */
+bool Listener::getReusePort() const
+{
+    return _reusePort;
+}
+
+/**
+ * Indique si ce port est un socket Unix
+ * return true pour AF_UNIX
+ */
+bool Listener::isUnix() const
+{
+    return _unix;
+}
+
+/**
+ * Indique si les connexions reçues échappent au contrôle de flood
+ * return true pour un port de confiance
+ */
+bool Listener::isTrusted() const
+{
+    return _trusted;
+}
+
+/**
+ * Récupère la classe des connexions reçues
+ * return Nom de la classe
+ */
+const std::string& Listener::getClassName() const
+{
+    return _className;
+}
+
+/**
+ * Récupère la limite de connexions du port
+ * return Connexions simultanées permises (0 = limite globale seule)
+ */
+unsigned int Listener::getMaxConnections() const
+{
+    return _maxConnections;
+}
+
+/**
+ * Récupère le nombre de connexions ouvertes reçues par ce port
+ * return Nombre de connexions
+ */
+unsigned int Listener::getConnections() const
+{
+    return _connections;
+}
+
+/**
+ * Convertit l'adresse d'écoute en chaîne
+ * return Adresse et port ([::]:6667 pour IPv6)
+ */
+std::string Listener::toString() const
+{
+    if (_unix)
+    {
+        return LISTENER_UNIX_PREFIX + _address;
+    }
+    if (_address.find(':') != std::string::npos)
+    {
+        return "[" + _address + "]:" + Utils::toString(_port);
+    }
+    return _address + ":" + Utils::toString(_port);
+}
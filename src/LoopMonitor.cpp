@@ -0,0 +1,199 @@
+#include "../includes/LoopMonitor.hpp"
+#include "../includes/Utils.hpp"
+
+/**
+ * Constructeur de la classe LoopMonitor
+ */
+LoopMonitor::LoopMonitor()
+    : _pollStart(0),
+      _busyStart(0),
+      _readyFds(0),
+      _iterationLines(0),
+      _iterationBytes(0),
+      _iterations(0),
+      _slowIterations(0),
+      _totalBusy(0),
+      _totalIdle(0),
+      _maxBusy(0),
+      _lagEstimate(0),
+      _loadEstimate(0),
+      _totalReadyFds(0),
+      _maxReadyFds(0),
+      _totalLines(0),
+      _totalBytesFlushed(0),
+      _lastWarning(0),
+      _suppressedWarnings(0)
+{
+    // vide
+}
+
+/**
+ * Destructeur de la classe LoopMonitor
+ */
+LoopMonitor::~LoopMonitor()
+{
+    // vide
+}
+
+/**
+ * Marque le début de l'attente dans poll
+ */
+void LoopMonitor::pollStarted()
+{
+    _pollStart = Utils::getMonotonicMicros();
+}
+
+/**
+ * Marque le retour de poll et le début du traitement de l'itération
+ * arg readyFds Nombre de descripteurs prêts renvoyé par poll
+ */
+void LoopMonitor::pollReturned(int readyFds)
+{
+    _busyStart = Utils::getMonotonicMicros();
+    _totalIdle += _busyStart - _pollStart;
+
+    _readyFds = readyFds > 0 ? readyFds : 0;
+    _iterationLines = 0;
+    _iterationBytes = 0;
+}
+
+/**
+ * Marque la fin du traitement de l'itération et met à jour les statistiques
+ */
+void LoopMonitor::iterationDone()
+{
+    uint64_t now = Utils::getMonotonicMicros();
+    uint64_t busy = now - _busyStart;
+    uint64_t idle = _busyStart - _pollStart;
+
+    _iterations++;
+    _totalBusy += busy;
+    if (busy > _maxBusy)
+    {
+        _maxBusy = busy;
+    }
+
+    // Moyennes glissantes: retard de la boucle et part du temps passé à travailler
+    int64_t lag = static_cast<int64_t>(_lagEstimate);
+    _lagEstimate = static_cast<uint64_t>(lag + (static_cast<int64_t>(busy) - lag) / LOOP_SMOOTHING);
+    if (busy + idle > 0)
+    {
+        int load = static_cast<int>(busy * 1000 / (busy + idle));
+        int previous = static_cast<int>(_loadEstimate);
+        _loadEstimate = static_cast<unsigned int>(previous + (load - previous) / LOOP_SMOOTHING);
+    }
+
+    _totalReadyFds += _readyFds;
+    if (_readyFds > _maxReadyFds)
+    {
+        _maxReadyFds = _readyFds;
+    }
+
+    // Avertir si l'itération a dépassé son budget, au plus une fois par intervalle
+    if (busy > LOOP_BUDGET_US)
+    {
+        _slowIterations++;
+        if (now - _lastWarning >= LOOP_WARN_INTERVAL_US)
+        {
+            std::string message = "Iteration de boucle lente: " + Utils::sizeToString(busy / 1000) + " ms (budget " +
+                                  Utils::toString(LOOP_BUDGET_US / 1000) + " ms), " + Utils::toString(_readyFds) +
+                                  " fds prets, " + Utils::toString(_iterationLines) + " lignes, " +
+                                  Utils::sizeToString(_iterationBytes) + " octets envoyes";
+            if (_suppressedWarnings > 0)
+            {
+                message += " (" + Utils::sizeToString(_suppressedWarnings) + " avertissements ignores)";
+            }
+            Utils::logMessage(message, true);
+            _lastWarning = now;
+            _suppressedWarnings = 0;
+        }
+        else
+        {
+            _suppressedWarnings++;
+        }
+    }
+}
+
+/**
+ * Comptabilise des lignes traitées pendant l'itération
+ * arg count Nombre de lignes
+ */
+void LoopMonitor::addLines(unsigned int count)
+{
+    _iterationLines += count;
+    _totalLines += count;
+}
+
+/**
+ * Comptabilise des octets envoyés aux clients
+ * arg bytes Nombre d'octets
+ */
+void LoopMonitor::addBytesFlushed(size_t bytes)
+{
+    _iterationBytes += bytes;
+    _totalBytesFlushed += bytes;
+}
+
+unsigned long LoopMonitor::getIterations() const
+{
+    return _iterations;
+}
+
+unsigned long LoopMonitor::getSlowIterations() const
+{
+    return _slowIterations;
+}
+
+uint64_t LoopMonitor::getLagEstimate() const
+{
+    return _lagEstimate;
+}
+
+uint64_t LoopMonitor::getMaxBusy() const
+{
+    return _maxBusy;
+}
+
+unsigned int LoopMonitor::getLoadEstimate() const
+{
+    return _loadEstimate;
+}
+
+unsigned long LoopMonitor::getTotalReadyFds() const
+{
+    return _totalReadyFds;
+}
+
+int LoopMonitor::getMaxReadyFds() const
+{
+    return _maxReadyFds;
+}
+
+unsigned long LoopMonitor::getTotalLines() const
+{
+    return _totalLines;
+}
+
+unsigned long LoopMonitor::getTotalBytesFlushed() const
+{
+    return _totalBytesFlushed;
+}
+
+/**
+ * Convertit les statistiques de la boucle en chaîne de caractères
+ * return Chaîne de caractères résumant l'état de la boucle
+ */
+std::string LoopMonitor::toString() const
+{
+    std::stringstream ss;
+    ss << "iterations=" << _iterations
+       << " lag=" << _lagEstimate << "us"
+       << " max=" << _maxBusy << "us"
+       << " load=" << _loadEstimate / 10 << "." << _loadEstimate % 10 << "%"
+       << " slow=" << _slowIterations
+       << " maxfds=" << _maxReadyFds
+       << " lines=" << _totalLines
+       << " flushed=" << _totalBytesFlushed;
+
+    return ss.str();
+}
@@ -0,0 +1,165 @@
+#include "../includes/MemoryReport.hpp"
+#include "../includes/Server.hpp"
+#include "../includes/Client.hpp"
+#include "../includes/Channel.hpp"
+#include "../includes/FileTransfer.hpp"
+#include "../includes/Bot.hpp"
+#include "../includes/Utils.hpp"
+
+/**
+ * Constructeur de la classe MemoryReport
+ */
+MemoryReport::MemoryReport()
+    : _clients(0),
+      _clientBytes(0),
+      _recvQBytes(0),
+      _sendQBytes(0),
+      _channels(0),
+      _channelBytes(0),
+      _memberships(0),
+      _memberBytes(0),
+      _invites(0),
+      _inviteBytes(0),
+      _topicBytes(0),
+      _fileTransferBytes(0),
+      _botBytes(0),
+      _serverBytes(0)
+{
+    // vide
+}
+
+/**
+ * Destructeur de la classe MemoryReport
+ */
+MemoryReport::~MemoryReport()
+{
+    // vide
+}
+
+/**
+ * Insère un consommateur dans un classement limité à MEMORY_TOP_N entrées
+ * arg top Classement trié par taille décroissante
+ * arg consumer Consommateur à insérer
+ */
+void MemoryReport::insertTop(std::vector<MemoryConsumer>& top, const MemoryConsumer& consumer)
+{
+    if (consumer.bytes == 0)
+    {
+        return;
+    }
+    if (top.size() >= MEMORY_TOP_N && top.back().bytes >= consumer.bytes)
+    {
+        return;
+    }
+
+    // Trouver la position d'insertion
+    std::vector<MemoryConsumer>::iterator it = top.begin();
+    while (it != top.end() && it->bytes >= consumer.bytes)
+    {
+        ++it;
+    }
+    top.insert(it, consumer);
+    if (top.size() > MEMORY_TOP_N)
+    {
+        top.pop_back();
+    }
+}
+
+/**
+ * Comptabilise la mémoire d'un client
+ * arg client Client à comptabiliser
+ */
+void MemoryReport::addClient(const Client* client)
+{
+    _clients++;
+    _clientBytes += client->getMemoryUsage();
+    _recvQBytes += client->getRecvQMemory();
+    _sendQBytes += client->getSendQMemory();
+
+    MemoryConsumer consumer;
+    consumer.name = client->getNickname().empty() ? "fd" + Utils::toString(client->getFd()) : client->getNickname();
+    consumer.bytes = client->getSendQ();
+    consumer.count = client->getSendQMessages();
+    insertTop(_topSendQ, consumer);
+}
+
+/**
+ * Comptabilise la mémoire d'un canal
+ * arg channel Canal à comptabiliser
+ */
+void MemoryReport::addChannel(const Channel* channel)
+{
+    size_t members = channel->getMembersMemory();
+    size_t invites = channel->getInvitesMemory();
+    size_t topic = channel->getTopicMemory();
+
+    _channels++;
+    _channelBytes += channel->getMemoryUsage();
+    _memberships += channel->getClientCount();
+    _memberBytes += members;
+    _invites += channel->getInviteCount();
+    _inviteBytes += invites;
+    _topicBytes += topic;
+
+    MemoryConsumer consumer;
+    consumer.name = channel->getName();
+    consumer.bytes = channel->getMemoryUsage() + members + invites + topic;
+    consumer.count = channel->getClientCount();
+    insertTop(_topChannels, consumer);
+}
+
+/**
+ * Comptabilise la mémoire propre au serveur: tables, commandes, bot et transferts
+ * arg server Serveur à comptabiliser
+ */
+void MemoryReport::addServer(const Server* server)
+{
+    _serverBytes = server->getMemoryUsage();
+    _fileTransferBytes = server->getFileTransfer() ? server->getFileTransfer()->getMemoryUsage() : 0;
+    _botBytes = server->getBot() ? server->getBot()->getMemoryUsage() : 0;
+}
+
+/**
+ * Calcule le total de la mémoire comptabilisée
+ * return Nombre d'octets
+ */
+size_t MemoryReport::getTotal() const
+{
+    return _clientBytes + _recvQBytes + _sendQBytes + _channelBytes + _memberBytes + _inviteBytes +
+           _topicBytes + _fileTransferBytes + _botBytes + _serverBytes;
+}
+
+/**
+ * Met en forme le rapport, une ligne par sous-système puis les classements
+ * return Lignes du rapport
+ */
+std::vector<std::string> MemoryReport::toLines() const
+{
+    std::vector<std::string> lines;
+
+    lines.push_back("Clients " + Utils::sizeToString(_clients) + " using " + Utils::sizeToString(_clientBytes) + " bytes");
+    lines.push_back("RecvQ using " + Utils::sizeToString(_recvQBytes) + " bytes");
+    lines.push_back("SendQ using " + Utils::sizeToString(_sendQBytes) + " bytes");
+    lines.push_back("Channels " + Utils::sizeToString(_channels) + " using " + Utils::sizeToString(_channelBytes) + " bytes");
+    lines.push_back("Members " + Utils::sizeToString(_memberships) + " using " + Utils::sizeToString(_memberBytes) + " bytes");
+    lines.push_back("Invites " + Utils::sizeToString(_invites) + " using " + Utils::sizeToString(_inviteBytes) + " bytes");
+    lines.push_back("Topics using " + Utils::sizeToString(_topicBytes) + " bytes");
+    lines.push_back("FileTransfer using " + Utils::sizeToString(_fileTransferBytes) + " bytes");
+    lines.push_back("Bot using " + Utils::sizeToString(_botBytes) + " bytes");
+    lines.push_back("Server tables using " + Utils::sizeToString(_serverBytes) + " bytes");
+    lines.push_back("Total " + Utils::sizeToString(getTotal()) + " bytes");
+
+    for (size_t i = 0; i < _topSendQ.size(); ++i)
+    {
+        lines.push_back("Top SendQ " + Utils::sizeToString(i + 1) + ": " + _topSendQ[i].name + " " +
+                        Utils::sizeToString(_topSendQ[i].bytes) + " bytes in " +
+                        Utils::sizeToString(_topSendQ[i].count) + " messages");
+    }
+    for (size_t i = 0; i < _topChannels.size(); ++i)
+    {
+        lines.push_back("Top channel " + Utils::sizeToString(i + 1) + ": " + _topChannels[i].name + " " +
+                        Utils::sizeToString(_topChannels[i].bytes) + " bytes, " +
+                        Utils::sizeToString(_topChannels[i].count) + " members");
+    }
+    return lines;
+}
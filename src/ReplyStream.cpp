@@ -0,0 +1,9 @@
+#include "../includes/ReplyStream.hpp"
+
+/**
+ * Destructeur de la classe de base ReplyStream
+ */
+ReplyStream::~ReplyStream()
+{
+    // vide
+}
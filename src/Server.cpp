@@ -2,29 +2,61 @@
 #include "../includes/Server.hpp"
 #include "../includes/Channel.hpp"
 #include "../includes/Utils.hpp"
+#include "../includes/Probes.hpp"
 #include <unistd.h>  // Pour close() et autres fonctions POSIX
 #include <cstring>   // Pour strerror
+#include <cstdlib>   // Pour getenv et atoi
+#include <fstream>   // Pour lire net.core.somaxconn
+
+#ifdef FT_IRC_USDT
+IRC_PROBE_LIST(IRC_PROBE_DEFINE)	// Sémaphores des sondes, en un seul exemplaire dans le binaire
+#endif
 
 
 Server::Server(int port, const std::string& password):
-    _serverSocket(-1),	// Socket serveur non initialisé
     _port(port),	// Port d'écoute du serveur
+    _backlog(LISTEN_BACKLOG_DEFAULT),	// File d'attente de listen
     _password(password),	// Mot de passe pour se connecter au serveur
     _serverName("ft_irc"),	// Nom par défaut du serveur IRC
     _creationDate(Utils::getCurrentTime()),	// Date de création du serveur
-    _nfds(1),	// Nombre de descripteurs suivis par poll
+    _startTime(time(NULL)),	// Heure de démarrage
+    _fanoutGeneration(0),	// Aucun événement diffusé
+    _nfds(0),	// Nombre de descripteurs suivis par poll
     _commandHandler(NULL),
 	_running(false), // État d'exécution du serveur
+    _streamsReady(false),	// Aucune réponse longue en cours
+    _operatorCount(0),	// Aucun opérateur
+    _motdReloadPending(0),
     _fileTransfer(NULL),
     _bot(NULL)	// Pointeur vers le bot IRC
 
 {
 	memset(_fds, 0, sizeof(_fds));	// Initialiser le tableau de descripteurs à zéro
+	memset(&_registrationStats, 0, sizeof(_registrationStats));	// Aucun échec d'enregistrement
 	_commandHandler  = new CommandHandler(this);	// Créer le gestionnaire de commandes
 
 	initFileTransfer();	// Initialiser le gestionnaire de transfert de fichiers
 	initBot();	// Initialiser le bot IRC
 
+	// Traçage optionnel: IRC_TRACE_FILE=<fichier> [IRC_TRACE_SAMPLE=<1 ligne sur N>]
+	const char* traceFile = getenv("IRC_TRACE_FILE");
+	if(traceFile && *traceFile){
+		const char* traceSample = getenv("IRC_TRACE_SAMPLE");
+		int sampleRate = traceSample ? atoi(traceSample) : TRACE_DEFAULT_SAMPLE;
+		_tracer.open(traceFile, sampleRate > 0 ? sampleRate : TRACE_DEFAULT_SAMPLE);
+	}
+
+	_admission.load(ADMISSION_CONFIG_FILE);	// Règles d'admission des connexions
+	loadOperators(OPER_CONFIG_FILE);	// Sans fichier, personne ne peut devenir opérateur
+	_welcome.init(_serverName, _creationDate);	// Parties fixes de la rafale d'enregistrement
+	_welcome.loadMotd(MOTD_FILE);
+
+	// File d'attente de listen: IRC_LISTEN_BACKLOG=<connexions> (bornée à somaxconn au démarrage)
+	const char* backlog = getenv("IRC_LISTEN_BACKLOG");
+	if(backlog && atoi(backlog) > 0){
+		_backlog = atoi(backlog);
+	}
+
 	Utils::logMessage("Serveur IRC cree sur le port " + Utils::toString(port) + " avec le mot de passe");	// Log de création du serveur
 }
 
@@ -39,6 +71,8 @@ Server::~Server(){
 		delete it->second;
 	}
 	_clients.clear();
+	_nicknames.clear();
+	_monitors.clear();
 	//les canaux
 	for (std::map<std::string, Channel*>::iterator it = _channels.begin(); it != _channels.end(); ++it)
 	{
@@ -62,19 +96,19 @@ Server::~Server(){
 		delete _bot;
 		_bot = NULL;
 	}
-	// Fermer le socket serveur s'il est ouvert
-	if (_serverSocket != -1)
+	// Fermer les sockets en écoute
+	for (size_t i = 0; i < _listeners.size(); ++i)
 	{
-		close(_serverSocket);
-		_serverSocket = -1;
+		delete _listeners[i];
 	}
+	_listeners.clear();
 	Utils::logMessage("Serveur IRC détruit");
 }
 
 void Server::start(){
 	if (_running)
 		return;
-	setupServerSocket();// Config socket du serveur
+	setupListeners();// Ouvrir les sockets en écoute
 
 	// serveur en cours d'exec
 	_running = true;
@@ -82,8 +116,16 @@ void Server::start(){
 
 	while (_running)
 	{
+		if (_motdReloadPending){
+			_motdReloadPending = 0;
+			_welcome.loadMotd(MOTD_FILE);	// Hors du gestionnaire de signal
+		}
 		// Attendre des événements sur les sockets avec poll
-		int pollResult = poll(_fds, _nfds, 1000);  // Timeout de 1 seconde
+		refreshPollEvents();
+		_loopMonitor.pollStarted();
+		// Dormir jusqu'au prochain timer, sauf si des réponses ou des lignes sont en attente
+		int timeout = (_streamsReady || !_runQueue.empty()) ? 0 : _timerWheel.nextTimeout(Utils::getMonotonicMicros() / 1000);
+		int pollResult = poll(_fds, _nfds, timeout);
 		if (pollResult < 0)
 		{
 			if (errno == EINTR){
@@ -93,31 +135,45 @@ void Server::start(){
 				throw std::runtime_error("Erreur lors de l'appel à poll: " + std::string(strerror(errno)));
 			}
 		}
+		_loopMonitor.pollReturned(pollResult);
+		size_t queued = _runQueue.size();	// Clients en file au début du tour, avant les lectures
 
-		// Vérifier si poll a expiré sans événements
-		if (pollResult == 0)
-			continue;
-
-		// Traiter les événements
-		for (int i = 0; i < _nfds; ++i)
+		// Traiter les événements (aucun si poll a expiré)
+		for (int i = 0; pollResult > 0 && i < _nfds; ++i)
 		{
 			// Vérifier s'il y a un événement sur ce descripteur
 			if (_fds[i].revents == 0){
 				continue;
 			}
-			if (_fds[i].fd == _serverSocket){// Vérifier si c'est le socket serveur
-				acceptNewConnection();// Nouvelle connexion
+			short revents = _fds[i].revents;
+			_fds[i].revents = 0;	// Avant le traitement: removeClient peut décaler une autre entrée à cette place
+			if (i < static_cast<int>(_listeners.size())){// Les sockets en écoute sont en tête de _fds
+				acceptNewConnection(_listeners[i]);// Nouvelles connexions (une connexion récupérée est après i)
 			}
 			else{
-				handleClientMessage(_fds[i].fd);// Msg du client
+				int fd = _fds[i].fd;
+				if (revents & POLLOUT){// Le socket peut de nouveau recevoir
+					Client* client = getClient(fd);
+					if (client)
+						client->processMessages();
+				}
+				if (revents & ~POLLOUT){// POLLIN, POLLHUP, POLLERR, POLLNVAL: la lecture constate l'erreur
+					handleClientMessage(fd);// Msg du client
+				}
+				if (i < _nfds && _fds[i].fd != fd){
+					--i;	// Client supprimé: l'entrée suivante occupe sa place et n'a pas encore été traitée
+				}
 			}
-			_fds[i].revents = 0;
 		}
+		runClients(queued);
+		pumpStreams();
+		_timerWheel.advance(Utils::getMonotonicMicros() / 1000);
+		reapClients();
+		_loopMonitor.iterationDone();
 	}
-	if (_serverSocket != -1)// Fermer le socket serveur
+	for (size_t i = 0; i < _listeners.size(); ++i)// Fermer les sockets en écoute
 	{
-		close(_serverSocket);
-		_serverSocket = -1;
+		_listeners[i]->close();
 	}
 	Utils::logMessage("Serveur IRC arrêté");
 }
@@ -136,28 +192,50 @@ void Server::removeClient(int clientFd){
 	}
 	Client* client = it->second;	// Obtenir le client
 	Utils::logMessage("Client deconnecte: " + client->toString());	// Log de déconnexion du client
-
-	if(client->isRegistered() && !client->getNickname().empty()){
-		broadcast(":" + client->getNickname() + " !"  + client->getUsername() + "@" +
-					client->getHostname() + " QUIT :Connection closed", clientFd); }
-
-		//quitter les canaux
-		std::vector<Channel*> channels = client->getChannels();
-		for(size_t i = 0; i < channels.size(); ++i){
-			channels[i]->removeClient(client);	// Supprimer le client de chaque canal
-			if(channels[i]->getClientCount() == 0){
-				_channels.erase(Utils::toLower(channels[i]->getName()));	// Supprimer le canal s'il n'y a plus de clients
-				delete channels[i];	// Supprimer le canal
+	IRC_PROBE2(client__remove, clientFd, client->isRegistered());
+
+	// Un seul QUIT par client partageant au moins un canal (QUIT, ping timeout, fermeture...)
+	std::string reason = client->getQuitMessage().empty() ? "Connection closed" : client->getQuitMessage();
+	broadcastToPeers(client, ":" + client->getNickname() + "!" + client->getUsername() + "@" +
+					client->getHostname() + " QUIT :" + reason);
+
+	//quitter les canaux
+	std::vector<Channel*> channels = client->getChannels();
+	for(size_t i = 0; i < channels.size(); ++i){
+		channels[i]->removeClient(client);	// Supprimer le client de chaque canal
+		if(channels[i]->getClientCount() == 0){
+			_channels.erase(Utils::toLower(channels[i]->getName()));	// Supprimer le canal s'il n'y a plus de clients
+			delete channels[i];	// Supprimer le canal
 		}
 	}
 	close(clientFd);
+	if(client->isOperator()){
+		updateOperatorCount(false);	// 252 de la rafale d'enregistrement
+	}
+	if(client->isAdmitted()){
+		_admission.release(client->getAddress());
+	}
+	if(client->getListener()){
+		client->getListener()->removeConnection();
+	}
 	_clients.erase(it);
+	std::map<std::string, Client*>::iterator nick = _nicknames.find(Utils::toLower(client->getNickname()));
+	if(nick != _nicknames.end() && nick->second == client){
+		_nicknames.erase(nick);
+	}
+	clearMonitors(client);
+	if(client->isOnline()){
+		notifyMonitors(client->getNickname(), NULL);
+	}
+	removePendingClient(client);
+	_streamingFds.erase(clientFd);
+	_closingFds.erase(clientFd);
 	delete client;	// Supprimer le client
 
 	for(int i = 0; i <_nfds; ++i){
 		if(_fds[i].fd == clientFd){
 
-			for(int j = i; j < _nfds - 1; ++i){
+			for(int j = i; j < _nfds - 1; ++j){
 				_fds[j] = _fds[j + 1];	// Décaler les descripteurs
 			}
 			_nfds--;
@@ -179,6 +257,88 @@ std::string Server::getCreationDate() const{
 	return _creationDate;
 }
 
+time_t Server::getStartTime() const{
+	return _startTime;
+}
+
+LoopMonitor& Server::getLoopMonitor(){
+	return _loopMonitor;
+}
+
+const LoopMonitor& Server::getLoopMonitor() const{
+	return _loopMonitor;
+}
+
+Tracer& Server::getTracer(){
+	return _tracer;
+}
+
+TimerWheel& Server::getTimerWheel(){
+	return _timerWheel;
+}
+
+const Admission& Server::getAdmission() const{
+	return _admission;
+}
+
+const WelcomeBurst& Server::getWelcome() const{
+	return _welcome;
+}
+
+void Server::requestMotdReload(){
+	_motdReloadPending = 1;	// Le fichier est relu par la boucle, pas dans le gestionnaire
+}
+
+CommandHandler* Server::getCommandHandler() const{
+	return _commandHandler;
+}
+
+FileTransfer* Server::getFileTransfer() const{
+	return _fileTransfer;
+}
+
+Bot* Server::getBot() const{
+	return _bot;
+}
+
+size_t Server::getMemoryUsage() const{
+	// Structure du serveur, nœuds des tables de clients et de canaux, commandes
+	size_t bytes = sizeof(Server) + Utils::stringMemory(_password) + Utils::stringMemory(_serverName) +
+					Utils::stringMemory(_creationDate);
+	bytes += _clients.size() * (MEMORY_TREE_NODE_OVERHEAD + sizeof(std::map<int, Client*>::value_type));
+	for(std::map<std::string, Client*>::const_iterator it = _nicknames.begin(); it != _nicknames.end(); ++it){
+		bytes += MEMORY_TREE_NODE_OVERHEAD + sizeof(std::map<std::string, Client*>::value_type) + Utils::stringMemory(it->first);
+	}
+	for(std::map<std::string, std::vector<Client*> >::const_iterator it = _monitors.begin(); it != _monitors.end(); ++it){
+		bytes += MEMORY_TREE_NODE_OVERHEAD + sizeof(std::map<std::string, std::vector<Client*> >::value_type) +
+				Utils::stringMemory(it->first) + it->second.capacity() * sizeof(Client*);
+	}
+	for(std::map<std::string, Channel*>::const_iterator it = _channels.begin(); it != _channels.end(); ++it){
+		bytes += MEMORY_TREE_NODE_OVERHEAD + sizeof(std::map<std::string, Channel*>::value_type) + Utils::stringMemory(it->first);
+	}
+	bytes += _streamingFds.size() * (MEMORY_TREE_NODE_OVERHEAD + sizeof(int));
+	if(_commandHandler){
+		bytes += _commandHandler->getMemoryUsage();
+	}
+	bytes += _admission.getMemoryUsage();
+	for(std::map<std::string, std::string>::const_iterator it = _operators.begin(); it != _operators.end(); ++it){
+		bytes += MEMORY_TREE_NODE_OVERHEAD + sizeof(std::map<std::string, std::string>::value_type) +
+				Utils::stringMemory(it->first) + Utils::stringMemory(it->second);
+	}
+	bytes += _welcome.getMemoryUsage();
+	return bytes;
+}
+
+void Server::collectMemoryReport(MemoryReport& report) const{
+	for(std::map<int, Client*>::const_iterator it = _clients.begin(); it != _clients.end(); ++it){
+		report.addClient(it->second);
+	}
+	for(std::map<std::string, Channel*>::const_iterator it = _channels.begin(); it != _channels.end(); ++it){
+		report.addChannel(it->second);
+	}
+	report.addServer(this);
+}
+
 
 Client* Server::getClient(int fd) const{
 	std::map<int, Client*>::const_iterator it = _clients.find(fd);	// Rechercher le client par son descripteur de fichier
@@ -189,19 +349,130 @@ Client* Server::getClient(int fd) const{
 }
 
 Client* Server::getClientByNickname(const std::string& nickname) const{
-	//parcourir tous les clients
-	for(std::map<int, Client*>::const_iterator it = _clients.begin(); it != _clients.end(); ++it){
-		if(Utils::toLower(it->second->getNickname()) == Utils::toLower(nickname)){
-			return it->second;//si le pseudo correspond, retourner le client
+	// Recherche dans l'index plutôt qu'un parcours de tous les clients
+	std::map<std::string, Client*>::const_iterator it = _nicknames.find(Utils::toLower(nickname));
+	if(it == _nicknames.end()){
+		return NULL;
+	}
+	return it->second;
+}
+
+void Server::renameClient(Client* client, const std::string& nickname){
+	std::map<std::string, Client*>::iterator it = _nicknames.find(Utils::toLower(client->getNickname()));
+	if(it != _nicknames.end() && it->second == client){
+		_nicknames.erase(it);	// Libérer l'ancien pseudo
+	}
+	if(client->isOnline()){
+		notifyMonitors(client->getNickname(), NULL);	// L'ancien pseudo n'est plus présent
+	}
+	client->setNickname(nickname);
+	std::vector<Channel*> channels = client->getChannels();
+	for(size_t i = 0; i < channels.size(); ++i){
+		channels[i]->refreshNames(client);	// Seule l'entrée NAMES de ce membre change
+	}
+	if(!nickname.empty()){
+		_nicknames[Utils::toLower(nickname)] = client;
+	}
+	if(client->isOnline()){
+		notifyMonitors(nickname, client);
+	}
+}
+
+void Server::broadcastToPeers(Client* client, const std::string& message){
+	// Génération propre à l'événement: un membre déjà marqué a reçu la ligne par un autre canal
+	unsigned long generation = ++_fanoutGeneration;
+	client->setFanoutStamp(generation);	// L'auteur n'est pas servi
+	size_t fanout = 0;
+	std::vector<Channel*> channels = client->getChannels();
+	for(size_t i = 0; i < channels.size(); ++i){
+		fanout += channels[i]->broadcastStamped(message, generation);
+	}
+	IRC_PROBE2(peers__broadcast, client->getFd(), fanout);
+}
+
+void Server::loadOperators(const std::string& path){
+	std::ifstream file(path.c_str());
+	if(!file.is_open()){
+		Utils::logMessage("OPER: fichier " + path + " non trouvé, aucun compte opérateur");
+		return;
+	}
+	std::string line;
+	while(std::getline(file, line)){
+		std::vector<std::string> words = Utils::split(line, ' ');
+		if(words.empty() || words[0][0] == '#'){
+			continue;	// Ligne vide ou commentaire
+		}
+		if(words.size() != 2){
+			Utils::logMessage("OPER: ligne ignorée dans " + path + ": " + line, true);
+			continue;
 		}
+		_operators[words[0]] = words[1];
+	}
+	Utils::logMessage("OPER: " + Utils::sizeToString(_operators.size()) + " comptes chargés depuis " + path);
+}
+
+bool Server::checkOperator(const std::string& name, const std::string& password) const{
+	std::map<std::string, std::string>::const_iterator it = _operators.find(name);
+	return it != _operators.end() && it->second == password;
+}
+
+void Server::addMonitor(Client* watcher, const std::string& key){
+	if(watcher->isMonitoring(key)){
+		return;
+	}
+	watcher->addMonitored(key);
+	_monitors[key].push_back(watcher);
+}
+
+void Server::removeMonitor(Client* watcher, const std::string& key){
+	std::map<std::string, std::vector<Client*> >::iterator it = _monitors.find(key);
+	if(it == _monitors.end() || !watcher->isMonitoring(key)){
+		return;
+	}
+	watcher->removeMonitored(key);
+	std::vector<Client*>& watchers = it->second;
+	for(size_t i = 0; i < watchers.size(); ++i){
+		if(watchers[i] == watcher){
+			watchers[i] = watchers.back();	// L'ordre des observateurs n'a pas d'importance
+			watchers.pop_back();
+			break;
+		}
+	}
+	if(watchers.empty()){
+		_monitors.erase(it);	// Pas d'entrée vide pour un pseudo que plus personne ne surveille
+	}
+}
+
+void Server::clearMonitors(Client* watcher){
+	std::vector<std::string> keys = watcher->getMonitored();
+	for(size_t i = 0; i < keys.size(); ++i){
+		removeMonitor(watcher, keys[i]);
+	}
+	watcher->clearMonitored();
+}
+
+void Server::notifyMonitors(const std::string& nickname, Client* online){
+	if(nickname.empty()){
+		return;
+	}
+	std::map<std::string, std::vector<Client*> >::iterator it = _monitors.find(Utils::toLower(nickname));
+	if(it == _monitors.end()){
+		return;
+	}
+	// Seul le pseudo de l'observateur change d'une ligne à l'autre
+	std::string head = ":" + _serverName + (online ? " 730 " : " 731 ");
+	std::string tail = online ? " :" + nickname + "!" + online->getUsername() + "@" + online->getHostname()
+							  : " :" + nickname;
+	const std::vector<Client*>& watchers = it->second;
+	for(size_t i = 0; i < watchers.size(); ++i){
+		watchers[i]->sendMessage(head + watchers[i]->getNickname() + tail, LANE_BULK);
 	}
-	return NULL;
 }
 
 void Server::broadcast(const std::string& message, int excludeFd){
 	for(std::map<int, Client*>::iterator it = _clients.begin(); it != _clients.end(); ++it){
 		if(it->first != excludeFd && it->second->isRegistered()){
-			it->second->sendMessage(message);	// Envoyer le message à tous les clients sauf celui qui l'a envoyé
+			it->second->sendMessage(message, LANE_BULK);	// Envoyer le message à tous les clients sauf celui qui l'a envoyé
 		}
 	}
 	Utils::logMessage("Message broadcast: " + message);	// Log du message broadcast
@@ -211,10 +482,184 @@ unsigned int Server::getClientCount() const{
 	return _clients.size();	// nombre de clients connectés
 }
 
+unsigned int Server::getOperatorCount() const{
+	return _operatorCount;	// nombre d'opérateurs connectés
+}
+
+void Server::updateOperatorCount(bool op){
+	if(op){
+		_operatorCount++;
+	}else if(_operatorCount > 0){
+		_operatorCount--;
+	}
+}
+
 unsigned int Server::getChannelCount() const{
 	return _channels.size();	// nombre de canaux existants
 }
 
+Client* Server::getClientAfter(int fd) const{
+	// Reprendre au premier client dont le fd suit le curseur (robuste aux déconnexions)
+	std::map<int, Client*>::const_iterator it = _clients.upper_bound(fd);
+	if(it == _clients.end()){
+		return NULL;
+	}
+	return it->second;
+}
+
+Channel* Server::getChannelAfter(const std::string& key) const{
+	// Reprendre au premier canal dont le nom suit le curseur (robuste aux suppressions)
+	std::map<std::string, Channel*>::const_iterator it = _channels.upper_bound(key);
+	if(it == _channels.end()){
+		return NULL;
+	}
+	return it->second;
+}
+
+void Server::scheduleStreams(Client* client){
+	if(client && client->getFd() >= 0){
+		_streamingFds.insert(client->getFd());
+		_streamsReady = true;
+	}
+}
+
+void Server::scheduleRemoval(int fd){
+	if(fd >= 0){
+		_closingFds.insert(fd);
+	}
+}
+
+void Server::reapClients(){
+	while(!_closingFds.empty()){
+		int fd = *_closingFds.begin();
+		Client* client = getClient(fd);
+		if(client){
+			client->processMessages();	// Dernière tentative d'envoi (ERROR, réponses en attente)
+		}
+		_closingFds.erase(_closingFds.begin());
+		removeClient(fd);
+	}
+}
+
+void Server::scheduleRun(Client* client){
+	if(!client->isRunnable()){
+		client->setRunnable(true);
+		_runQueue.push_back(client->getFd());
+	}
+}
+
+void Server::runClients(size_t count){
+	// Seuls les clients en file au début du tour passent: ceux ajoutés par les lectures attendent le suivant
+	while(count-- > 0 && !_runQueue.empty()){
+		int fd = _runQueue.front();
+		_runQueue.pop_front();
+		Client* client = getClient(fd);
+		if(!client || !client->isRunnable()){
+			continue;	// Client fermé entre-temps (ou fd réutilisé)
+		}
+		client->setRunnable(false);
+		if(client->getStatus() != DISCONNECTED){
+			processClientBuffer(client);
+			client->processMessages();
+		}
+	}
+}
+
+unsigned int Server::getRunQueueLength() const{
+	return _runQueue.size();
+}
+
+void Server::removePendingClient(Client* client){
+	if(client && client->isPending()){
+		_pendingClients.erase(client->getPendingPosition());
+		client->setPending(false, _pendingClients.end());
+	}
+}
+
+unsigned int Server::getPendingCount() const{
+	return _pendingClients.size();
+}
+
+void Server::recordRegistrationTimeout(bool passwordAccepted){
+	if(passwordAccepted){
+		_registrationStats.timedOutPassword++;
+	}
+	else{
+		_registrationStats.timedOutConnecting++;
+	}
+}
+
+const RegistrationStats& Server::getRegistrationStats() const{
+	return _registrationStats;
+}
+
+AcceptStats Server::getAcceptStats() const{
+	AcceptStats total;
+	memset(&total, 0, sizeof(total));
+	for(size_t i = 0; i < _listeners.size(); ++i){
+		const AcceptStats& stats = _listeners[i]->getStats();
+		total.accepted += stats.accepted;
+		total.bursts += stats.bursts;
+		total.capped += stats.capped;
+		total.overflows += stats.overflows;
+		total.refused += stats.refused;
+		if(stats.maxQueue > total.maxQueue){
+			total.maxQueue = stats.maxQueue;
+		}
+	}
+	return total;
+}
+
+int Server::getListenBacklog() const{
+	return _backlog;
+}
+
+const std::vector<Listener*>& Server::getListeners() const{
+	return _listeners;
+}
+
+bool Server::reapOldestPending(){
+	if(_pendingClients.empty()){
+		return false;
+	}
+	// La connexion la plus ancienne est celle qui a eu le plus de temps pour s'enregistrer
+	Client* oldest = _pendingClients.front();
+	Utils::logMessage("Connexion non enregistrée fermée pour libérer une place: " + oldest->toString(), true);
+	oldest->sendMessage("ERROR :Closing Link: " + oldest->getHostname() + " (Server full, registration too slow)");
+	oldest->processMessages();	// La place est libérée tout de suite: envoyer l'ERROR avant de fermer
+	_registrationStats.reaped++;
+	removeClient(oldest->getFd());
+	return true;
+}
+
+void Server::pumpStreams(){
+	_streamsReady = false;
+	std::set<int>::iterator it = _streamingFds.begin();
+	while(it != _streamingFds.end()){
+		Client* client = getClient(*it);
+		if(!client || client->pumpStreams()){
+			_streamingFds.erase(it++);	// Plus rien à émettre pour ce client
+			continue;
+		}
+		// Si la SendQ est pleine, on attend POLLOUT; sinon on reprend au prochain tour sans dormir
+		if(client->getSendQ() < STREAM_SENDQ_LOWAT){
+			_streamsReady = true;
+		}
+		++it;
+	}
+}
+
+void Server::refreshPollEvents(){
+	for(int i = _listeners.size(); i < _nfds; ++i){
+		Client* client = getClient(_fds[i].fd);
+		// Un client qui a déjà des lignes en attente n'est plus lu: le noyau retient le reste
+		_fds[i].events = (client && client->isRunnable()) ? 0 : POLLIN;
+		if(client && client->getSendQ() > 0){
+			_fds[i].events |= POLLOUT;	// Reprendre l'envoi dès que le socket se libère
+		}
+	}
+}
+
 Channel* Server::getChannel(const std::string& name) const{
 	std::map<std::string, Channel*>::const_iterator it = _channels.find(Utils::toLower(name));
 	if(it != _channels.end()){
@@ -315,77 +760,160 @@ void Server::handleBotCommand(Client* client, const std::string& command, const
 }
 
 
-void Server::setupServerSocket(){
-	//creer le socket serveur
-	_serverSocket = socket(AF_INET, SOCK_STREAM, 0);
-	if(_serverSocket < 0){
-		throw std::runtime_error("Erreur lors de la creation du socket serveur: " + std::string(strerror(errno)));
-	}
-	int opt = 1;
-	if(setsockopt(_serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0){
-		close(_serverSocket);
-		throw std::runtime_error("Erreur lors de la configuration du socket serveur: " + std::string(strerror(errno)));
+void Server::setupListeners(){
+	// Le noyau tronque silencieusement la file à somaxconn: la lire pour afficher la valeur réelle
+	std::ifstream somaxconnFile(SOMAXCONN_PATH);
+	int somaxconn = 0;
+	if(!(somaxconnFile >> somaxconn)){
+		somaxconn = 0;
 	}
 
-	int flags = fcntl(_serverSocket, F_GETFL, 0);
-	if(flags == -1){
-		close(_serverSocket);
-		throw std::runtime_error("Erreur lors de la récupération des flags du socket serveur: " + std::string(strerror(errno)));
-	}
-	if(fcntl(_serverSocket, F_SETFL, flags | O_NONBLOCK) == -1){
-		close(_serverSocket);
-		throw std::runtime_error("Erreur lors de la configuration du socket serveur en mode non-bloquant: " + std::string(strerror(errno)));
-	}
+	// Port de la ligne de commande: double pile sur toutes les adresses
+	_listeners.push_back(new Listener("::", _port, _backlog, false, LISTENER_DEFAULT_CLASS, 0));
+	_listeners.back()->setProfile(LISTENER_DEFAULT_PROFILE);
 
-	struct sockaddr_in serverAddr;
-	memset(&serverAddr, 0, sizeof(serverAddr));	// Initialiser la structure d'adresse
-	serverAddr.sin_family = AF_INET;	// IPv4
-	serverAddr.sin_addr.s_addr = INADDR_ANY;	// Accepter toutes les adresses
-	serverAddr.sin_port = htons(_port);	// Port d'ecoute
-	if(bind(_serverSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) < 0){ //lire socket
-		close(_serverSocket);
-		throw std::runtime_error("Erreur lors de la liaison du socket serveur: " + std::string(strerror(errno)));
-	}
-	if(listen(_serverSocket, 5) < 0){ //mettre le socket en ecoute
-		close(_serverSocket);
-		throw std::runtime_error("Erreur lors de l'écoute du socket serveur: " + std::string(strerror(errno)));
+	// Ports supplémentaires: <adresse> <port> [options] ou unix:<chemin> [options]
+	// Options: backlog=N reuseport class=nom max=N trusted mode=0660
+	// Réglages des sockets: profile=default|lowlatency|bulk puis nodelay sndbuf=N rcvbuf=N
+	// keepalive=idle/intervalle/sondes user_timeout=ms notsent_lowat=N
+	std::ifstream file(LISTENER_CONFIG_FILE);
+	std::string line;
+	while(std::getline(file, line)){
+		std::vector<std::string> words = Utils::split(line, ' ');
+		if(words.empty() || words[0][0] == '#'){
+			continue;
+		}
+		bool isUnix = words[0].compare(0, strlen(LISTENER_UNIX_PREFIX), LISTENER_UNIX_PREFIX) == 0;
+		int port = isUnix ? 0 : (words.size() >= 2 ? atoi(words[1].c_str()) : 0);
+		if((!isUnix && (port <= 0 || port > 65535)) || _listeners.size() >= MAX_LISTENERS){
+			Utils::logMessage("Port d'écoute ignoré: " + line, true);
+			continue;
+		}
+		int backlog = _backlog;
+		bool reusePort = false;
+		bool trusted = false;
+		unsigned int mode = LISTENER_UNIX_MODE;
+		std::string className = LISTENER_DEFAULT_CLASS;
+		unsigned int maxConnections = 0;
+		std::vector<std::string> tuning;	// Réglages des sockets, appliqués une fois le port créé
+		for(size_t i = isUnix ? 1 : 2; i < words.size(); ++i){
+			if(words[i] == "reuseport"){
+				reusePort = true;
+			}else if(words[i] == "trusted"){
+				trusted = true;	// Robots et outils de charge: pas de contrôle de flood
+			}else if(isUnix && words[i].compare(0, 5, "mode=") == 0){
+				mode = strtol(words[i].c_str() + 5, NULL, 8);
+			}else if(words[i].compare(0, 8, "backlog=") == 0 && atoi(words[i].c_str() + 8) > 0){
+				backlog = atoi(words[i].c_str() + 8);
+			}else if(words[i].compare(0, 6, "class=") == 0 && words[i].size() > 6){
+				className = words[i].substr(6);
+			}else if(words[i].compare(0, 4, "max=") == 0 && atoi(words[i].c_str() + 4) >= 0){
+				maxConnections = atoi(words[i].c_str() + 4);
+			}else if(words[i].compare(0, 8, "profile=") == 0){
+				tuning.insert(tuning.begin(), words[i]);	// Le profil de base avant ses ajustements
+			}else{
+				tuning.push_back(words[i]);
+			}
+		}
+		Listener* listener = new Listener(isUnix ? words[0].substr(strlen(LISTENER_UNIX_PREFIX)) : words[0],
+										port, backlog, reusePort, className, maxConnections);
+		if(isUnix){
+			listener->setUnix(mode);
+		}
+		listener->setTrusted(trusted);
+		for(size_t i = 0; i < tuning.size(); ++i){
+			if(!listener->setSocketOption(tuning[i])){
+				Utils::logMessage("Option inconnue ignorée pour " + words[0] + ": " + tuning[i], true);
+			}
+		}
+		_listeners.push_back(listener);
 	}
 
-	_fds[0].fd = _serverSocket;	// Ajouter le socket serveur au tableau de descripteurs
-	_fds[0].events = POLLIN;	// Événement de lecture
-
-	Utils::logMessage("Socket serveur configuré sur le port " + Utils::toString(_port));	// Log de configuration
+	for(size_t i = 0; i < _listeners.size(); ++i){
+		_listeners[i]->open(somaxconn);
+		_fds[_nfds].fd = _listeners[i]->getFd();	// Les sockets en écoute restent en tête du tableau
+		_fds[_nfds].events = POLLIN;
+		_nfds++;
+	}
 }
 
-void Server::acceptNewConnection(){
-	struct sockaddr_in clientAddr;
-	socklen_t addrLen = sizeof(clientAddr);
+void Server::acceptNewConnection(Listener* listener){
+	AcceptStats& stats = listener->getStats();
+	listener->sampleQueue();
+
+	// Vider la file du noyau jusqu'à EAGAIN, avec un plafond par réveil (poll nous rappellera)
+	unsigned long accepted = 0;
+	while(accepted < ACCEPT_PER_TURN){
+		struct sockaddr_storage clientAddr;
+		socklen_t addrLen = sizeof(clientAddr);
+		int clientFd = accept4(listener->getFd(), (struct sockaddr*)&clientAddr, &addrLen, SOCK_NONBLOCK | SOCK_CLOEXEC);	// Accepter la nouvelle connexion
+		if(clientFd < 0){
+			if(errno == EAGAIN || errno == EWOULDBLOCK){
+				break;	// File vide
+			}
+			if(errno == EINTR || errno == ECONNABORTED){
+				continue;	// Connexion abandonnée avant d'être acceptée
+			}
+			// Plus de descripteurs: libérer une connexion non enregistrée et réessayer
+			if((errno == EMFILE || errno == ENFILE) && reapOldestPending()){
+				continue;
+			}
+			Utils::logMessage("Erreur lors de l'acceptation d'une nouvelle connexion: " + std::string(strerror(errno)), true);
+			break;
+		}
+		accepted++;
+
+		// Port plein ou admission refusée: fermer avant toute allocation
+		IpAddress address;
+		bool known = Admission::fromSockaddr((struct sockaddr*)&clientAddr, address);
+		if(listener->isFull() || (known && !_admission.admit(address))){
+			close(clientFd);
+			stats.refused++;
+			continue;
+		}
+		listener->tune(clientFd);
+		addConnection(clientFd, known ? &address : NULL, listener);
+	}
 
-	int clientFd = accept(_serverSocket, (struct sockaddr*)&clientAddr, &addrLen);	// Accepter la nouvelle connexion
-	if(clientFd < 0){
-		Utils::logMessage("Erreur lors de l'acceptation d'une nouvelle connexion: " + std::string(strerror(errno)), true);
-		return;
+	stats.accepted += accepted;
+	if(accepted > 1){
+		stats.bursts++;
 	}
-	int flags = fcntl(clientFd, F_GETFL, 0); //config socket
-	if(flags != -1){
-		fcntl(clientFd, F_SETFL, flags | O_NONBLOCK); //mode non-bloquant
+	if(accepted == ACCEPT_PER_TURN){
+		stats.capped++;
 	}
-	if(_nfds >= MAX_CLIENTS + 1){
+}
+
+void Server::addConnection(int clientFd, const IpAddress* address, Listener* listener){
+	if(_nfds - static_cast<int>(_listeners.size()) >= MAX_CLIENTS && !reapOldestPending()){
+		if(address){
+			_admission.release(*address);	// Admise mais jamais ouverte
+		}
 		close(clientFd);	// Fermer la connexion si le nombre maximum de clients est atteint
 		Utils::logMessage("Nombre maximum de clients atteint, connexion refusee", true);
 		return;
 	}
 
 	Client* client = new Client(clientFd, this);
-	char hostStr[INET_ADDRSTRLEN];
-	inet_ntop(AF_INET, &(clientAddr.sin_addr), hostStr, INET6_ADDRSTRLEN);	// Convertir l'adresse IP en chaîne
-	client->setHostname(hostStr);	// Définir le nom d'hôte du client
+	if(address){
+		std::string host = Admission::formatAddress(*address);	// IPv4 affichée sans le préfixe ::ffff:
+		client->setHostname(host[0] == ':' ? "0" + host : host);	// Un paramètre IRC ne peut pas commencer par ':'
+		client->setAddress(*address);	// Libérée par removeClient
+	}else{
+		// Pair local: identité du processus (SO_PEERCRED) à la place d'un nom d'hôte
+		client->setHostname(listener->isUnix() ? Listener::peerIdentity(clientFd) : "unknown");
+	}
+	client->setListener(listener);
+	listener->addConnection();
 
 	_clients[clientFd] = client;	// Ajouter le client à la map des clients
+	client->setPending(true, _pendingClients.insert(_pendingClients.end(), client));	// En attente d'enregistrement
 	_fds[_nfds].fd = clientFd;	// Ajouter le descripteur de fichier du client au tableau de descripteurs
 	_fds[_nfds].events = POLLIN;	// Événement de lecture
+	_fds[_nfds].revents = 0;	// La place peut garder les événements d'un client supprimé pendant ce tour
 	_nfds++;	// Incrementer le nombre de descripteurs suivis par poll
-	Utils::logMessage("Nouvelle connexion accepte: " + client->toString());	// Log de la nouvelle connexion
+	IRC_PROBE1(client__accept, clientFd);
+	Utils::logMessage("Nouvelle connexion accepte: " + client->toString() + " sur " + listener->toString());	// Log de la nouvelle connexion
 }
 
 void Server::handleClientMessage(int clientFd){
@@ -397,46 +925,94 @@ void Server::handleClientMessage(int clientFd){
 	memset(buffer, 0, sizeof(buffer));	// Initialiser le buffer
 	ssize_t bytesRead = recv(clientFd, buffer, BUFFER_SIZE - 1, 0);	// Lire les données du client
 	if(bytesRead <= 0){
-		if(bytesRead <= 0 || errno != EWOULDBLOCK){
-			removeClient(clientFd);	// Supprimer le client si la lecture échoue
+		if(bytesRead < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)){
+			return;	// Rien à lire pour l'instant
 		}
+		removeClient(clientFd);	// Supprimer le client si la lecture échoue ou si la connexion est fermée
 		return;
 	}
+	client->recordReceivedBytes(bytesRead);
 	client->appendToBuffer(std::string (buffer, bytesRead));	// Ajouter les données lues au buffer du client
+
+	// Le client envoie plus vite que le contrôle de flood ne le laisse exécuter
+	if(client->getRecvQ() > MAX_RECVQ && client->getStatus() != DISCONNECTED){
+		client->setQuitMessage("Excess Flood");
+		client->sendMessage("ERROR :Closing Link: " + client->getHostname() + " (Excess Flood)");
+		client->setStatus(DISCONNECTED);
+		client->clearBuffer();
+		return;
+	}
+	// Un client déjà en file attend son tour; les données lues s'ajoutent à son buffer
+	if(!client->isRunnable()){
+		processClientBuffer(client);
+	}
+	client->processMessages();
+}
+
+void Server::processClientBuffer(Client* client){
+	int clientFd = client->getFd();
 	std::string clientBuffer = client->getBuffer();	// Obtenir le buffer du client
+	size_t start = 0;	// Début de la prochaine ligne à traiter
 	size_t pos;
-	while((pos = clientBuffer.find("\r\n")) != std::string::npos ||
-		(pos = clientBuffer.find("\n")) != std::string::npos){
-			std::string message = clientBuffer.substr(0, pos);	// Extraire le message
-			clientBuffer = clientBuffer.substr(pos + (clientBuffer[pos] == '\r' ? 2 : 1));
-			if(!message.empty()){
-				std::string cmdName;
-				size_t spacePos = message.find(' ');	// Trouver le premier espace
-				if(spacePos != std::string::npos){
-					cmdName = message.substr(0, spacePos);	// Extraire le nom de la commande
-				}else {
-					cmdName = message;	// Pas d'espace, le message est la commande
-				}
-				cmdName = Utils::toUpper(cmdName);	// Convertir le nom de la commande en majuscules
-				if(client->getStatus() == CONNECTING && cmdName != "PASS" && cmdName != "QUIT" && cmdName != "PING"){
-					client->sendMessage("464 : You must provide a valid password first with PASS command");	// Envoyer un message d'erreur");
-					continue;	// Sortir de la boucle si le client n'est pas enregistré
-				}
-				bool isValidCmd = _commandHandler->isCommandValid(cmdName);
-				if(isValidCmd){
-					Utils::logMessage("Message recu de " + client->getNickname() + ": " + message);	// Log du message reçu
-				}
-				_commandHandler->executeCommand(client, message);	// Traiter la commande
-			// message = Utils::trim(message);	// gestion espaces
-
-			// size_t nextPos = (clientBuffer[pos] == '\r' && pos + 1 < clientBuffer.size() && clientBuffer[pos + 1] == '\n') ? pos + 2 : pos + 1;
-			// clientBuffer = clientBuffer.substr(nextPos);	// Mettre à jour le buffer du client
-			// if(!message.empty()){
-			// 	Utils::logMessage("Message recu de " + client->getNickname() + ": " + message);	// Log du message reçu
-			// 	_commandHandler->executeCommand(client, message);	// Traiter la commande
-			}
+	unsigned int lines = 0;
+	uint64_t turnStart = Utils::getMonotonicMicros();
+	while(client->getStatus() != DISCONNECTED && (pos = clientBuffer.find('\n', start)) != std::string::npos){
+		// Budget du tour épuisé: le client reprendra après les autres
+		if(lines >= LINES_PER_TURN || Utils::getMonotonicMicros() - turnStart > CLIENT_TURN_US){
+			scheduleRun(client);
+			break;
+		}
+		size_t end = (pos > start && clientBuffer[pos - 1] == '\r') ? pos - 1 : pos;	// Accepter \r\n et \n
+		std::string message = clientBuffer.substr(start, end - start);	// Extraire le message
+		if(message.empty()){
+			start = pos + 1;
+			continue;
+		}
+		std::string cmdName;
+		size_t spacePos = message.find(' ');	// Trouver le premier espace
+		if(spacePos != std::string::npos){
+			cmdName = message.substr(0, spacePos);	// Extraire le nom de la commande
+		}else {
+			cmdName = message;	// Pas d'espace, le message est la commande
+		}
+		cmdName = Utils::toUpper(cmdName);	// Convertir le nom de la commande en majuscules
+
+		// Contrôle de flood: la ligne reste dans le buffer jusqu'à ce que la pénalité redescende
+		uint64_t waitMs = client->chargeFlood(_commandHandler->getFloodCost(cmdName));
+		if(waitMs > 0){
+			client->deferLines(waitMs);
+			break;
+		}
+		start = pos + 1;
+		lines++;
+
+		_loopMonitor.addLines(1);
+		client->recordReceivedMessage();
+		IRC_PROBE2(line__received, clientFd, message.size());
+		uint32_t traceId = _tracer.beginLine(clientFd, client->getLastRecvTime(), message.size());
+		if(client->getStatus() == CONNECTING && cmdName != "PASS" && cmdName != "QUIT" && cmdName != "PING" && cmdName != "CAP"){
+			client->sendMessage("464 : You must provide a valid password first with PASS command");	// Envoyer un message d'erreur");
+			_tracer.endLine();
+			continue;	// Ignorer la commande si le client n'a pas donné le mot de passe
+		}
+		bool isValidCmd = _commandHandler->isCommandValid(cmdName);
+		if(isValidCmd){
+			Utils::logMessage("Message recu de " + client->getNickname() + ": " + message);	// Log du message reçu
+		}
+		_tracer.record(traceId, TRACE_EXECUTE, clientFd, message.size());
+		_commandHandler->executeCommand(client, message);	// Traiter la commande
+		_tracer.record(traceId, TRACE_DONE, clientFd, message.size());
+		_tracer.endLine();
+	}
+	clientBuffer.erase(0, start);	// Retirer les lignes traitées
+
+	// Avant l'enregistrement, une ligne incomplète ne peut pas dépasser quelques centaines d'octets
+	if(!client->isRegistered() && client->getStatus() != DISCONNECTED && clientBuffer.size() > PREREG_RECVQ_MAX){
+		client->sendMessage("ERROR :Closing Link: " + client->getHostname() + " (Registration buffer exceeded)");
+		client->setStatus(DISCONNECTED);
+		_registrationStats.bufferExceeded++;
+		clientBuffer.clear();
 	}
 	client->clearBuffer();	// Vider le buffer du client
 	client->appendToBuffer(clientBuffer);	// Mettre a jour le buffer du client
-	client->processMessages();
 }
@@ -0,0 +1,177 @@
+#include "../includes/Stats.hpp"
+#include "../includes/Server.hpp"
+#include "../includes/Client.hpp"
+#include "../includes/Channel.hpp"
+#include "../includes/Command.hpp"
+#include "../includes/CommandHandler.hpp"
+#include "../includes/Utils.hpp"
+
+/**
+ * Constructeur du flux STATS m
+ * arg server Pointeur vers le serveur
+ */
+StatsCommandsStream::StatsCommandsStream(Server* server)
+    : _server(server),
+      _cursor("")
+{
+    // vide
+}
+
+/**
+ * Émet une ligne RPL_STATSCOMMANDS par commande utilisée
+ * arg client Client qui a demandé les statistiques
+ * arg budget Nombre de lignes encore autorisées pour ce tour
+ * return true quand toutes les commandes ont été émises
+ */
+bool StatsCommandsStream::pump(Client* client, unsigned int& budget)
+{
+    while (budget > 0)
+    {
+        Command* cmd = _server->getCommandHandler()->getCommandAfter(_cursor);
+        if (cmd == NULL)
+        {
+            client->sendReply("219 " + client->getNickname() + " m :End of STATS report");
+            return true;
+        }
+        _cursor = cmd->getName();
+
+        // Les commandes jamais utilisées ne sont pas listées
+        if (cmd->getUseCount() == 0)
+        {
+            continue;
+        }
+        client->sendReply("212 " + client->getNickname() + " " + cmd->getName() + " " +
+                          Utils::sizeToString(cmd->getUseCount()) + " " +
+                          Utils::sizeToString(cmd->getUseBytes()) + " 0");
+        budget--;
+    }
+    return false;
+}
+
+/**
+ * Constructeur du flux STATS l
+ * arg server Pointeur vers le serveur
+ */
+StatsLinksStream::StatsLinksStream(Server* server)
+    : _server(server),
+      _cursor(-1)
+{
+    // vide
+}
+
+/**
+ * Émet une ligne RPL_STATSLINKINFO par connexion
+ * arg client Client qui a demandé les statistiques
+ * arg budget Nombre de lignes encore autorisées pour ce tour
+ * return true quand toutes les connexions ont été émises
+ */
+bool StatsLinksStream::pump(Client* client, unsigned int& budget)
+{
+    time_t now = time(NULL);
+
+    while (budget > 0)
+    {
+        Client* link = _server->getClientAfter(_cursor);
+        if (link == NULL)
+        {
+            client->sendReply("219 " + client->getNickname() + " l :End of STATS report");
+            return true;
+        }
+        _cursor = link->getFd();
+
+        // <linkname> <sendq> <sent messages> <sent Kbytes> <received messages> <received Kbytes> <time open>
+        std::string nick = link->getNickname().empty() ? "*" : link->getNickname();
+        client->sendReply("211 " + client->getNickname() + " " + nick + "[" + link->getUsername() + "@" +
+                          link->getHostname() + "] " +
+                          Utils::sizeToString(link->getSendQ()) + " " +
+                          Utils::sizeToString(link->getMessagesSent()) + " " +
+                          Utils::sizeToString(link->getBytesSent() / 1024) + " " +
+                          Utils::sizeToString(link->getMessagesReceived()) + " " +
+                          Utils::sizeToString(link->getBytesReceived() / 1024) + " " +
+                          Utils::sizeToString(now - link->getConnectTime()) +
+                          " :RecvQ " + Utils::sizeToString(link->getRecvQ()) +
+                          " PrioQ " + Utils::sizeToString(link->getSendQ(LANE_PRIORITY)) +
+                          " Penalty " + Utils::sizeToString(link->getFloodPenalty()) + "ms" +
+                          " Deferred " + Utils::sizeToString(link->getFloodDeferrals()) +
+                          " Class " + link->getConnectionClass() +
+                          (link->getFd() >= 0 ? " " + Listener::describeSocket(link->getFd(), link->getListener() && !link->getListener()->isUnix()) : ""));
+        budget--;
+    }
+    return false;
+}
+
+/**
+ * Constructeur du flux STATS z
+ * arg server Pointeur vers le serveur
+ */
+StatsMemoryStream::StatsMemoryStream(Server* server)
+    : _server(server),
+      _clientCursor(-1),
+      _channelCursor(""),
+      _clientsDone(false),
+      _channelsDone(false),
+      _nextLine(0)
+{
+    // vide
+}
+
+/**
+ * Parcourt les clients puis les canaux par tranches et émet le rapport à la fin
+ * arg client Client qui a demandé les statistiques
+ * arg budget Nombre de lignes encore autorisées pour ce tour
+ * return true quand le rapport est complet
+ */
+bool StatsMemoryStream::pump(Client* client, unsigned int& budget)
+{
+    unsigned int entries = STATS_ENTRIES_PER_TURN;
+
+    // Clients: structure, chaînes, buffers d'entrée et de sortie
+    while (!_clientsDone && entries > 0)
+    {
+        Client* c = _server->getClientAfter(_clientCursor);
+        if (c == NULL)
+        {
+            _clientsDone = true;
+            break;
+        }
+        _clientCursor = c->getFd();
+        _report.addClient(c);
+        entries--;
+    }
+
+    // Canaux: structure, membres, invitations et sujet
+    while (_clientsDone && !_channelsDone && entries > 0)
+    {
+        Channel* ch = _server->getChannelAfter(_channelCursor);
+        if (ch == NULL)
+        {
+            _channelsDone = true;
+            _report.addServer(_server);
+            _lines = _report.toLines();
+            break;
+        }
+        _channelCursor = Utils::toLower(ch->getName());
+        _report.addChannel(ch);
+        entries--;
+    }
+
+    if (!_channelsDone)
+    {
+        return false;
+    }
+
+    // Émettre le rapport ligne par ligne
+    while (_nextLine < _lines.size() && budget > 0)
+    {
+        client->sendReply("249 " + client->getNickname() + " :" + _lines[_nextLine]);
+        _nextLine++;
+        budget--;
+    }
+    if (_nextLine < _lines.size() || budget == 0)
+    {
+        return false;
+    }
+    client->sendReply("219 " + client->getNickname() + " z :End of STATS report");
+    budget--;
+    return true;
+}
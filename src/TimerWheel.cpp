@@ -0,0 +1,266 @@
+#include "../includes/TimerWheel.hpp"
+#include "../includes/Utils.hpp"
+#include <climits>      // Pour INT_MAX
+
+/**
+ * Constructeur de la classe Timer (désarmé)
+ */
+Timer::Timer()
+    : _wheel(NULL),
+      _expires(0)
+{
+    prev = NULL;
+    next = NULL;
+}
+
+/**
+ * Destructeur de la classe Timer: se retire de la roue s'il est armé
+ */
+Timer::~Timer()
+{
+    if (_wheel)
+    {
+        _wheel->cancel(this);
+    }
+}
+
+/**
+ * Vérifie si le timer est armé
+ * return true si le timer attend son échéance, false sinon
+ */
+bool Timer::isPending() const
+{
+    return _wheel != NULL;
+}
+
+/**
+ * Constructeur de la classe TimerWheel, calée sur l'horloge monotone
+ */
+TimerWheel::TimerWheel()
+    : _current(Utils::getMonotonicMicros() / 1000 / TIMER_TICK_MS),
+      _pending(0)
+{
+    for (int level = 0; level < TIMER_LEVELS; ++level)
+    {
+        for (int slot = 0; slot < TIMER_SLOTS; ++slot)
+        {
+            _slots[level][slot].prev = &_slots[level][slot];
+            _slots[level][slot].next = &_slots[level][slot];
+        }
+    }
+}
+
+/**
+ * Destructeur de la classe TimerWheel: désarme les timers restants
+ */
+TimerWheel::~TimerWheel()
+{
+    for (int level = 0; level < TIMER_LEVELS; ++level)
+    {
+        for (int slot = 0; slot < TIMER_SLOTS; ++slot)
+        {
+            TimerLink* head = &_slots[level][slot];
+            while (head->next != head)
+            {
+                unlink(static_cast<Timer*>(head->next));
+            }
+        }
+    }
+}
+
+/**
+ * Range un timer dans la case correspondant à son échéance
+ * arg timer Timer à chaîner (_expires déjà renseigné)
+ */
+void TimerWheel::link(Timer* timer)
+{
+    if (timer->_expires < _current)
+    {
+        timer->_expires = _current;
+    }
+
+    // Choisir le niveau selon l'éloignement de l'échéance
+    uint64_t delta = timer->_expires - _current;
+    int level = 0;
+    while (level < TIMER_LEVELS - 1 && delta >= (static_cast<uint64_t>(1) << (TIMER_SLOT_BITS * (level + 1))))
+    {
+        level++;
+    }
+
+    // Au-delà de la portée du dernier niveau, l'échéance est ramenée à sa limite
+    uint64_t range = static_cast<uint64_t>(1) << (TIMER_SLOT_BITS * TIMER_LEVELS);
+    if (delta >= range)
+    {
+        timer->_expires = _current + range - 1;
+    }
+
+    TimerLink* head = &_slots[level][(timer->_expires >> (TIMER_SLOT_BITS * level)) & TIMER_SLOT_MASK];
+    TimerLink* node = timer;
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+    timer->_wheel = this;
+    _pending++;
+}
+
+/**
+ * Retire un timer de sa liste
+ * arg timer Timer à retirer
+ */
+void TimerWheel::unlink(Timer* timer)
+{
+    TimerLink* node = timer;
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = NULL;
+    node->next = NULL;
+    timer->_wheel = NULL;
+    _pending--;
+}
+
+/**
+ * Redistribue les timers de la case courante d'un niveau vers les niveaux inférieurs
+ * arg level Niveau à faire descendre
+ */
+void TimerWheel::cascade(int level)
+{
+    TimerLink* head = &_slots[level][(_current >> (TIMER_SLOT_BITS * level)) & TIMER_SLOT_MASK];
+    while (head->next != head)
+    {
+        Timer* timer = static_cast<Timer*>(head->next);
+        unlink(timer);
+        link(timer);
+    }
+}
+
+/**
+ * Arme (ou réarme) un timer
+ * arg timer Timer à armer
+ * arg delayMs Délai avant l'échéance (en millisecondes)
+ */
+void TimerWheel::schedule(Timer* timer, uint64_t delayMs)
+{
+    if (timer->_wheel)
+    {
+        timer->_wheel->cancel(timer);
+    }
+    timer->_expires = _current + delayMs / TIMER_TICK_MS;
+    link(timer);
+}
+
+/**
+ * Annule un timer armé
+ * arg timer Timer à annuler
+ */
+void TimerWheel::cancel(Timer* timer)
+{
+    if (timer->_wheel == this)
+    {
+        unlink(timer);
+    }
+}
+
+/**
+ * Traite tous les ticks écoulés et déclenche les timers échus
+ * arg nowMs Horloge monotone (en millisecondes)
+ */
+void TimerWheel::advance(uint64_t nowMs)
+{
+    uint64_t now = nowMs / TIMER_TICK_MS;
+
+    // Roue vide: rien à faire tourner
+    if (_pending == 0)
+    {
+        if (now >= _current)
+        {
+            _current = now + 1;
+        }
+        return;
+    }
+
+    while (_current <= now)
+    {
+        // Quand un niveau fait un tour, le niveau supérieur descend d'un cran
+        for (int level = 1; level < TIMER_LEVELS; ++level)
+        {
+            if (((_current >> (TIMER_SLOT_BITS * (level - 1))) & TIMER_SLOT_MASK) != 0)
+            {
+                break;
+            }
+            cascade(level);
+        }
+
+        // Détacher la case échue: les timers réarmés pendant expire() ne sont pas revus ce tick
+        TimerLink* head = &_slots[0][_current & TIMER_SLOT_MASK];
+        TimerLink due;
+        due.prev = &due;
+        due.next = &due;
+        if (head->next != head)
+        {
+            due.next = head->next;
+            due.prev = head->prev;
+            due.next->prev = &due;
+            due.prev->next = &due;
+            head->next = head;
+            head->prev = head;
+        }
+        _current++;
+
+        while (due.next != &due)
+        {
+            Timer* timer = static_cast<Timer*>(due.next);
+            unlink(timer);
+            timer->expire();
+        }
+    }
+}
+
+/**
+ * Calcule le délai maximum d'attente de poll avant le prochain timer
+ * arg nowMs Horloge monotone (en millisecondes)
+ * return Délai en millisecondes, ou -1 si aucun timer n'est armé
+ */
+int TimerWheel::nextTimeout(uint64_t nowMs) const
+{
+    if (_pending == 0)
+    {
+        return -1;
+    }
+
+    // Chercher une case occupée au premier niveau, jusqu'au prochain tour de roue
+    uint64_t due = _current;
+    for (int i = 0; i < TIMER_SLOTS; ++i)
+    {
+        due = _current + i;
+        if (i > 0 && (due & TIMER_SLOT_MASK) == 0)
+        {
+            break;  // Les niveaux supérieurs descendent ici
+        }
+        const TimerLink* head = &_slots[0][due & TIMER_SLOT_MASK];
+        if (head->next != head)
+        {
+            break;
+        }
+    }
+
+    uint64_t dueMs = due * TIMER_TICK_MS;
+    if (dueMs <= nowMs)
+    {
+        return 0;
+    }
+    if (dueMs - nowMs > static_cast<uint64_t>(INT_MAX))
+    {
+        return INT_MAX;
+    }
+    return static_cast<int>(dueMs - nowMs);
+}
+
+/**
+ * Récupère le nombre de timers armés
+ * return Nombre de timers
+ */
+unsigned long TimerWheel::getPending() const
+{
+    return _pending;
+}
@@ -0,0 +1,169 @@
+#include "../includes/Tracer.hpp"
+#include "../includes/Utils.hpp"
+#include <fcntl.h>      // Pour open
+#include <unistd.h>     // Pour write et close
+#include <cstring>      // Pour strerror
+#include <cerrno>       // Pour errno
+
+/**
+ * Constructeur de la classe Tracer (désactivé par défaut)
+ */
+Tracer::Tracer()
+    : _fd(-1),
+      _sampleRate(TRACE_DEFAULT_SAMPLE),
+      _lineCounter(0),
+      _nextId(1),
+      _current(0)
+{
+    // vide
+}
+
+/**
+ * Destructeur de la classe Tracer
+ */
+Tracer::~Tracer()
+{
+    if (_fd != -1)
+    {
+        flush();
+        close(_fd);
+        _fd = -1;
+    }
+}
+
+/**
+ * Active le traçage vers un fichier
+ * arg path Chemin du fichier de trace
+ * arg sampleRate Une ligne tracée sur sampleRate (1 = toutes)
+ * return true si le fichier a été ouvert, false sinon
+ */
+bool Tracer::open(const std::string& path, unsigned int sampleRate)
+{
+    _fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (_fd == -1)
+    {
+        Utils::logMessage("Impossible d'ouvrir le fichier de trace " + path + ": " + std::string(strerror(errno)), true);
+        return false;
+    }
+    if (write(_fd, TRACE_MAGIC, 8) != 8)
+    {
+        Utils::logMessage("Impossible d'écrire l'en-tête de trace: " + std::string(strerror(errno)), true);
+        close(_fd);
+        _fd = -1;
+        return false;
+    }
+    _sampleRate = sampleRate > 0 ? sampleRate : 1;
+    _buffer.reserve(TRACE_BUFFER_RECORDS);
+
+    Utils::logMessage("Traçage des messages actif vers " + path + " (1 ligne sur " + Utils::toString(_sampleRate) + ")");
+    return true;
+}
+
+/**
+ * Vérifie si le traçage est actif
+ * return true si les traces sont enregistrées, false sinon
+ */
+bool Tracer::isEnabled() const
+{
+    return _fd != -1;
+}
+
+/**
+ * Écrit les enregistrements en attente dans le fichier
+ */
+void Tracer::flush()
+{
+    if (_fd == -1 || _buffer.empty())
+    {
+        return;
+    }
+    size_t length = _buffer.size() * sizeof(TraceRecord);
+    if (write(_fd, &_buffer[0], length) != static_cast<ssize_t>(length))
+    {
+        Utils::logMessage("Écriture de trace incomplète, traçage désactivé: " + std::string(strerror(errno)), true);
+        close(_fd);
+        _fd = -1;
+    }
+    _buffer.clear();
+}
+
+/**
+ * Décide si une ligne est échantillonnée et, si oui, ouvre sa trace
+ * arg fd Client qui a envoyé la ligne
+ * arg recvTime Moment où les données de la ligne ont été reçues
+ * arg bytes Taille de la ligne
+ * return Identifiant de trace ou 0 si la ligne n'est pas tracée
+ */
+uint32_t Tracer::beginLine(int fd, uint64_t recvTime, size_t bytes)
+{
+    _current = 0;
+    if (_fd == -1 || (_lineCounter++ % _sampleRate) != 0)
+    {
+        return 0;
+    }
+
+    _current = _nextId++;
+    if (_nextId == 0)
+    {
+        _nextId = 1;
+    }
+
+    // La réception est datée du recv qui a complété la ligne
+    TraceRecord received;
+    received.timestamp = recvTime;
+    received.traceId = _current;
+    received.fd = fd;
+    received.event = TRACE_RECV;
+    received.reserved = 0;
+    received.bytes = static_cast<uint32_t>(bytes);
+    _buffer.push_back(received);
+
+    record(_current, TRACE_PARSE, fd, bytes);
+    return _current;
+}
+
+/**
+ * Termine la trace de la ligne en cours
+ */
+void Tracer::endLine()
+{
+    _current = 0;
+}
+
+/**
+ * Récupère la trace de la ligne en cours d'exécution
+ * return Identifiant de trace ou 0
+ */
+uint32_t Tracer::current() const
+{
+    return _current;
+}
+
+/**
+ * Enregistre une étape d'une ligne tracée
+ * arg traceId Identifiant de trace (ignoré si 0)
+ * arg event Étape atteinte
+ * arg fd Client concerné
+ * arg bytes Taille concernée
+ */
+void Tracer::record(uint32_t traceId, TraceEvent event, int fd, size_t bytes)
+{
+    if (traceId == 0 || _fd == -1)
+    {
+        return;
+    }
+
+    TraceRecord rec;
+    rec.timestamp = Utils::getMonotonicMicros();
+    rec.traceId = traceId;
+    rec.fd = fd;
+    rec.event = static_cast<uint16_t>(event);
+    rec.reserved = 0;
+    rec.bytes = static_cast<uint32_t>(bytes);
+    _buffer.push_back(rec);
+
+    if (_buffer.size() >= TRACE_BUFFER_RECORDS)
+    {
+        flush();
+    }
+}
@@ -161,6 +161,19 @@ namespace Utils
         return ss.str();
     }
 
+    /**
+     * Convertit une taille (ou un compteur) en chaîne
+     * arg value Valeur à convertir
+     * return Chaîne représentant la valeur
+     */
+    std::string sizeToString(size_t value)
+    {
+        std::stringstream ss;
+        ss << value;
+
+        return ss.str();
+    }
+
     /**
      * Récupère l'heure actuelle au format "YYYY-MM-DD HH:MM:SS"
      * return Chaîne représentant l'heure actuelle
@@ -195,6 +208,19 @@ namespace Utils
         return std::string(buffer);
     }
 
+    /**
+     * Récupère une horloge monotone en microsecondes
+     * (insensible aux changements de l'heure système, pour mesurer des durées)
+     * return Nombre de microsecondes depuis un point arbitraire
+     */
+    uint64_t getMonotonicMicros()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000 + static_cast<uint64_t>(ts.tv_nsec) / 1000;
+    }
+
     /**
      * Affiche un message de log
      * arg message Message à afficher
@@ -280,6 +306,60 @@ namespace Utils
         return true;
     }
 
+    /**
+     * Compare une chaîne à un masque IRC sans tenir compte de la casse
+     * '*' remplace zéro ou plusieurs caractères, '?' exactement un
+     * arg mask Masque (ex: #*dev*, nick!*@*.fr)
+     * arg str Chaîne à tester
+     * return true si la chaîne correspond au masque, false sinon
+     */
+    bool matchMask(const std::string& mask, const std::string& str)
+    {
+        size_t m = 0;
+        size_t s = 0;
+        size_t star = std::string::npos;    // Position de la dernière étoile rencontrée
+        size_t resume = 0;                  // Position dans str où l'étoile reprend
+
+        while (s < str.size())
+        {
+            if (m < mask.size() && mask[m] == '*')
+            {
+                star = m++;
+                resume = s;
+            }
+            else if (m < mask.size() && (mask[m] == '?' || tolower(mask[m]) == tolower(str[s])))
+            {
+                m++;
+                s++;
+            }
+            else if (star != std::string::npos)
+            {
+                // Échec: l'étoile absorbe un caractère de plus
+                m = star + 1;
+                s = ++resume;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        while (m < mask.size() && mask[m] == '*')
+        {
+            m++;
+        }
+        return m == mask.size();
+    }
+
+    /**
+     * Vérifie si un masque contient des jokers
+     * arg mask Masque à tester
+     * return true si le masque contient '*' ou '?', false sinon
+     */
+    bool hasWildcards(const std::string& mask)
+    {
+        return mask.find_first_of("*?") != std::string::npos;
+    }
+
     /**
      * Formate un message IRC
      * arg prefix Préfixe du message
@@ -550,6 +630,21 @@ namespace Utils
         return static_cast<size_t>(st.st_size);
     }
 
+    /**
+     * Estime la mémoire allouée sur le tas par une chaîne
+     * (les chaînes courtes sont stockées dans l'objet lui-même et ne coûtent rien de plus)
+     * arg str Chaîne à mesurer
+     * return Nombre d'octets alloués en dehors de l'objet
+     */
+    size_t stringMemory(const std::string& str)
+    {
+        if (str.capacity() <= 15)
+        {
+            return 0;
+        }
+        return str.capacity() + 1;
+    }
+
     /**
      * Sécurise une entrée utilisateur
      * arg input Entrée à sécuriser
@@ -0,0 +1,331 @@
+#include "../includes/Welcome.hpp"
+#include "../includes/Client.hpp"
+#include "../includes/Command.hpp"
+#include "../includes/Utils.hpp"
+#include <fcntl.h>      // Pour open
+#include <unistd.h>     // Pour close
+#include <sys/mman.h>   // Pour mmap et munmap
+#include <sys/stat.h>   // Pour fstat
+
+/**
+ * Constructeur: MOTD intégré tant qu'aucun fichier n'a été chargé
+ */
+WelcomeBurst::WelcomeBurst()
+    : _motdFromFile(false),
+      _burstSize(0),
+      _motdBlockSize(0)
+{
+    _motd.push_back("Welcome to ft_irc!");
+    _motd.push_back("This server is running ft_irc 1.0");
+    _motd.push_back("Have fun!");
+}
+
+/**
+ * Fixe le nom et la date du serveur, puis pré-rend les modèles
+ * arg serverName Nom du serveur (préfixe des numériques)
+ * arg creationDate Date affichée par 003
+ */
+void WelcomeBurst::init(const std::string& serverName, const std::string& creationDate)
+{
+    _serverName = serverName;
+    _creationDate = creationDate;
+    build();
+}
+
+/**
+ * Charge le MOTD depuis un fichier projeté en mémoire, puis reconstruit les modèles.
+ * Le fichier n'est lu qu'ici (démarrage et SIGHUP), jamais à l'enregistrement d'un client.
+ * arg path Chemin du fichier
+ * return false si le fichier est absent ou illisible (le MOTD précédent est conservé)
+ */
+bool WelcomeBurst::loadMotd(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        Utils::logMessage("MOTD: fichier " + path + " non trouvé, message " +
+                          (_motdFromFile ? "précédent" : "intégré") + " conservé");
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode))
+    {
+        close(fd);
+        Utils::logMessage("MOTD: " + path + " n'est pas un fichier lisible", true);
+        return false;
+    }
+
+    std::vector<std::string> lines;
+    if (st.st_size > 0)
+    {
+        void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED)
+        {
+            close(fd);
+            Utils::logMessage("MOTD: impossible de projeter " + path + " en mémoire", true);
+            return false;
+        }
+        const char* text = static_cast<const char*>(data);
+        size_t size = static_cast<size_t>(st.st_size);
+        size_t start = 0;
+        while (start < size && lines.size() < MOTD_MAX_LINES)
+        {
+            size_t end = start;
+            while (end < size && text[end] != '\n')
+                end++;
+            size_t length = end - start;
+            if (length > 0 && text[start + length - 1] == '\r')
+                length--;
+            lines.push_back(std::string(text + start, length > MOTD_LINE_MAX ? MOTD_LINE_MAX : length));
+            start = end + 1;
+        }
+        munmap(data, st.st_size);
+    }
+    close(fd);
+
+    _motd.swap(lines);
+    _motdFromFile = true;
+    build();
+    Utils::logMessage("MOTD: " + Utils::sizeToString(_motd.size()) + " lignes chargées depuis " + path);
+    return true;
+}
+
+/**
+ * Jetons 005 tirés des limites et des fonctions réellement présentes
+ * return Jetons dans l'ordre d'annonce
+ */
+std::vector<std::string> WelcomeBurst::isupportTokens()
+{
+    std::vector<std::string> tokens;
+    tokens.push_back("CASEMAPPING=ascii");
+    tokens.push_back("CHANTYPES=#&");
+    tokens.push_back("PREFIX=" ISUPPORT_PREFIX);
+    tokens.push_back("CHANMODES=" ISUPPORT_CHANMODES);
+    tokens.push_back("ELIST=CMNTU");    // Filtres de ListStream: date, masque, exclusion, sujet, membres
+    tokens.push_back("SAFELIST");       // LIST émis par morceaux au rythme de la SendQ
+    tokens.push_back("WHOX");
+    tokens.push_back("MONITOR=" + Utils::toString(MONITOR_MAX_TARGETS));
+    tokens.push_back("TARGMAX=PRIVMSG:" + Utils::toString(MAX_MESSAGE_TARGETS) + ",NOTICE:" +
+                     Utils::toString(MAX_MESSAGE_TARGETS) + ",JOIN:" +
+                     Utils::toString(MAX_JOIN_TARGETS));
+    return tokens;
+}
+
+/**
+ * Pré-rend la rafale d'enregistrement et le bloc MOTD
+ */
+void WelcomeBurst::build()
+{
+    _burst.clear();
+
+    addLine(_burst, "001");
+    addText(_burst, " :Welcome to the Internet Relay Network ");
+    addField(_burst, WELCOME_MASK);
+    addLine(_burst, "002");
+    addText(_burst, " :Your host is " + _serverName + ", running version ft_irc 1.0");
+    addLine(_burst, "003");
+    addText(_burst, " :This server was created " + _creationDate);
+    addLine(_burst, "004");
+    addText(_burst, " " + _serverName + " ft_irc 1.0 o iklopstv");
+
+    std::vector<std::string> tokens = isupportTokens();
+    for (size_t i = 0; i < tokens.size(); i += ISUPPORT_PER_LINE)
+    {
+        addLine(_burst, "005");
+        for (size_t j = i; j < tokens.size() && j < i + ISUPPORT_PER_LINE; ++j)
+            addText(_burst, " " + tokens[j]);
+        addText(_burst, " :are supported by this server");
+    }
+
+    addLine(_burst, "251");
+    addText(_burst, " :There are ");
+    addField(_burst, WELCOME_USERS);
+    addText(_burst, " users and 0 invisible on 1 servers");
+    addLine(_burst, "252");
+    addText(_burst, " ");
+    addField(_burst, WELCOME_OPERS);
+    addText(_burst, " :operator(s) online");
+    addLine(_burst, "254");
+    addText(_burst, " ");
+    addField(_burst, WELCOME_CHANNELS);
+    addText(_burst, " :channels formed");
+    addLine(_burst, "255");
+    addText(_burst, " :I have ");
+    addField(_burst, WELCOME_USERS);
+    addText(_burst, " clients and 1 servers");
+    addMotdLines(_burst);
+    _burstSize = textSize(_burst);
+
+    _motdBlock.clear();
+    addMotdLines(_motdBlock);
+    _motdBlockSize = textSize(_motdBlock);
+}
+
+/**
+ * Ouvre une ligne ":serveur <numérique> <pseudo>" (CRLF avant toute ligne sauf la première)
+ * arg tpl Modèle à compléter
+ * arg numeric Numérique de la ligne
+ */
+void WelcomeBurst::addLine(std::vector<WelcomeSegment>& tpl, const std::string& numeric)
+{
+    addText(tpl, (tpl.empty() ? ":" : "\r\n:") + _serverName + " " + numeric + " ");
+    addField(tpl, WELCOME_NICK);
+}
+
+/**
+ * Ajoute 375, les lignes 372 et 376 (ou 422 si le fichier du MOTD est vide)
+ * arg tpl Modèle à compléter
+ */
+void WelcomeBurst::addMotdLines(std::vector<WelcomeSegment>& tpl)
+{
+    if (_motd.empty())
+    {
+        addLine(tpl, "422");
+        addText(tpl, " :MOTD File is missing");
+        return;
+    }
+    addLine(tpl, "375");
+    addText(tpl, " :- " + _serverName + " Message of the day - ");
+    for (size_t i = 0; i < _motd.size(); ++i)
+    {
+        addLine(tpl, "372");
+        addText(tpl, " :- " + _motd[i]);
+    }
+    addLine(tpl, "376");
+    addText(tpl, " :End of /MOTD command");
+}
+
+/**
+ * Ajoute du texte fixe, fusionné avec le segment courant s'il n'a pas encore de champ
+ * arg tpl Modèle à compléter
+ * arg text Texte déjà sérialisé
+ */
+void WelcomeBurst::addText(std::vector<WelcomeSegment>& tpl, const std::string& text)
+{
+    if (tpl.empty() || tpl.back().field != WELCOME_NONE)
+    {
+        WelcomeSegment segment;
+        segment.field = WELCOME_NONE;
+        tpl.push_back(segment);
+    }
+    tpl.back().text += text;
+}
+
+/**
+ * Ajoute un champ propre au client après le texte courant
+ * arg tpl Modèle à compléter
+ * arg field Valeur à insérer à l'assemblage
+ */
+void WelcomeBurst::addField(std::vector<WelcomeSegment>& tpl, WelcomeField field)
+{
+    if (tpl.empty() || tpl.back().field != WELCOME_NONE)
+    {
+        WelcomeSegment segment;
+        segment.field = WELCOME_NONE;
+        tpl.push_back(segment);
+    }
+    tpl.back().field = field;
+}
+
+/**
+ * Calcule la taille du texte fixe d'un modèle
+ * arg tpl Modèle
+ * return Nombre d'octets hors champs
+ */
+size_t WelcomeBurst::textSize(const std::vector<WelcomeSegment>& tpl)
+{
+    size_t size = 0;
+    for (size_t i = 0; i < tpl.size(); ++i)
+        size += tpl[i].text.size();
+    return size;
+}
+
+/**
+ * Assemble un modèle pour un client en une seule allocation
+ * arg tpl Modèle
+ * arg size Taille du texte fixe du modèle
+ * arg client Destinataire
+ * arg users Clients connectés
+ * arg opers Opérateurs connectés
+ * arg channels Canaux existants
+ * return Lignes séparées par CRLF, sans le CRLF final
+ */
+std::string WelcomeBurst::render(const std::vector<WelcomeSegment>& tpl, size_t size, Client* client,
+                                 unsigned int users, unsigned int opers, unsigned int channels)
+{
+    const std::string& nick = client->getNickname();
+    std::string mask = nick + "!" + client->getUsername() + "@" + client->getHostname();
+    std::string usersText = Utils::sizeToString(users);
+    std::string opersText = Utils::sizeToString(opers);
+    std::string channelsText = Utils::sizeToString(channels);
+
+    std::string out;
+    out.reserve(size + tpl.size() * mask.size());
+    for (size_t i = 0; i < tpl.size(); ++i)
+    {
+        out += tpl[i].text;
+        switch (tpl[i].field)
+        {
+            case WELCOME_NICK:
+                out += nick;
+                break;
+            case WELCOME_MASK:
+                out += mask;
+                break;
+            case WELCOME_USERS:
+                out += usersText;
+                break;
+            case WELCOME_OPERS:
+                out += opersText;
+                break;
+            case WELCOME_CHANNELS:
+                out += channelsText;
+                break;
+            case WELCOME_NONE:
+                break;
+        }
+    }
+    return out;
+}
+
+/**
+ * Assemble la rafale d'enregistrement d'un client (001 à 376)
+ * arg client Client qui vient de s'enregistrer
+ * arg users Clients connectés
+ * arg opers Opérateurs connectés (252)
+ * arg channels Canaux existants
+ * return Rafale complète, à envoyer par un seul sendMessage
+ */
+std::string WelcomeBurst::renderBurst(Client* client, unsigned int users, unsigned int opers,
+                                      unsigned int channels) const
+{
+    return render(_burst, _burstSize, client, users, opers, channels);
+}
+
+/**
+ * Assemble le bloc MOTD seul (commande MOTD)
+ * arg client Destinataire
+ * return Lignes 375 à 376, ou 422
+ */
+std::string WelcomeBurst::renderMotd(Client* client) const
+{
+    return render(_motdBlock, _motdBlockSize, client, 0, 0, 0);
+}
+
+/**
+ * Estime la mémoire occupée par les modèles et le MOTD
+ * return Nombre d'octets
+ */
+size_t WelcomeBurst::getMemoryUsage() const
+{
+    size_t bytes = Utils::stringMemory(_serverName) + Utils::stringMemory(_creationDate) +
+                   _motd.capacity() * sizeof(std::string) +
+                   (_burst.capacity() + _motdBlock.capacity()) * sizeof(WelcomeSegment);
+    for (size_t i = 0; i < _motd.size(); ++i)
+        bytes += Utils::stringMemory(_motd[i]);
+    for (size_t i = 0; i < _burst.size(); ++i)
+        bytes += Utils::stringMemory(_burst[i].text);
+    for (size_t i = 0; i < _motdBlock.size(); ++i)
+        bytes += Utils::stringMemory(_motdBlock[i].text);
+    return bytes;
+}
@@ -0,0 +1,308 @@
+#include "../includes/WhoStream.hpp"
+#include "../includes/Server.hpp"
+#include "../includes/Client.hpp"
+#include "../includes/Channel.hpp"
+#include "../includes/Utils.hpp"
+
+/**
+ * Prépare un masque WHO
+ * arg mask Masque tel que reçu ("*", "0", nom exact ou motif avec jokers)
+ */
+WhoMask::WhoMask(const std::string& mask)
+    : _pattern(Utils::toLower(mask)),
+      _kind(MASK_GLOB)
+{
+    if (mask.empty() || mask == "0" || mask.find_first_not_of('*') == std::string::npos)
+    {
+        _kind = MASK_ALL;
+    }
+    else if (!Utils::hasWildcards(mask))
+    {
+        _kind = MASK_LITERAL;
+    }
+}
+
+/**
+ * Retourne la forme du masque
+ * return MASK_ALL, MASK_LITERAL ou MASK_GLOB
+ */
+WhoMask::Kind WhoMask::getKind() const
+{
+    return _kind;
+}
+
+/**
+ * Vérifie si une chaîne correspond au masque (sans tenir compte de la casse)
+ * arg str Chaîne à tester
+ * return true si elle correspond, false sinon
+ */
+bool WhoMask::matches(const std::string& str) const
+{
+    if (_kind == MASK_ALL)
+    {
+        return true;
+    }
+    if (_kind == MASK_LITERAL)
+    {
+        return str.size() == _pattern.size() && Utils::toLower(str) == _pattern;
+    }
+    return Utils::matchMask(_pattern, str);
+}
+
+/**
+ * Constructeur du flux WHO
+ * arg server Pointeur vers le serveur
+ * arg mask Cible: canal, pseudo ou masque
+ * arg options Second paramètre: drapeaux, puis %champs[,jeton] pour WHOX
+ */
+WhoStream::WhoStream(Server* server, const std::string& mask, const std::string& options)
+    : _server(server),
+      _mask(mask.empty() ? "*" : mask),
+      _target(WHO_MASK),
+      _matcher(mask),
+      _operOnly(false),
+      _nextMember(0),
+      _cursor(-1),
+      _visible(true),
+      _started(false)
+{
+    if (mask[0] == '#' || mask[0] == '&')
+    {
+        _target = WHO_CHANNEL;
+    }
+    else if (_matcher.getKind() == WhoMask::MASK_LITERAL)
+    {
+        _target = WHO_NICK;
+    }
+
+    size_t percent = options.find('%');
+    _operOnly = options.substr(0, percent).find('o') != std::string::npos;
+    if (percent != std::string::npos)
+    {
+        std::string whox = options.substr(percent + 1);
+        size_t comma = whox.find(',');
+        _fields = whox.substr(0, comma);
+        if (_fields.empty())
+        {
+            _fields = "n"; // %seul: au moins le pseudo, pour rester une réponse 354
+        }
+        if (comma != std::string::npos && _fields.find('t') != std::string::npos)
+        {
+            _token = whox.substr(comma + 1, WHOX_TOKEN_MAX);
+            if (_token.empty() || _token.find_first_not_of("0123456789") != std::string::npos)
+            {
+                _token = "0";
+            }
+        }
+    }
+}
+
+/**
+ * Résout la cible au premier tour: membres du canal ou pseudo exact
+ * arg client Client qui a demandé la liste
+ */
+void WhoStream::start(Client* client)
+{
+    if (_target == WHO_CHANNEL)
+    {
+        Channel* channel = _server->getChannel(_mask);
+        if (channel == NULL)
+        {
+            return;
+        }
+        // Un canal secret n'a pas de membres pour ceux qui n'y sont pas
+        _visible = !(channel->getModes() & MODE_SECRET) || channel->hasClient(client);
+        if (_visible)
+        {
+            std::vector<Client*> members = channel->getClients();
+            _members.reserve(members.size());
+            for (size_t i = 0; i < members.size(); ++i)
+            {
+                _members.push_back(members[i]->getNickname());
+            }
+        }
+        return;
+    }
+
+    if (_target == WHO_NICK)
+    {
+        // Une connexion pas encore enregistrée n'apparaît pas plus ici que dans le parcours par masque
+        Client* target = _server->getClientByNickname(_mask);
+        if (target && target->isRegistered())
+        {
+            _members.push_back(target->getNickname());
+        }
+        else
+        {
+            // Pas de pseudo de ce nom: le mot peut désigner un hôte, un utilisateur ou un nom réel
+            _target = WHO_MASK;
+        }
+    }
+}
+
+/**
+ * Vérifie si un client correspond au masque (WHO_MASK)
+ * arg target Client examiné
+ * return true s'il doit figurer dans la réponse
+ */
+bool WhoStream::matches(Client* target)
+{
+    if (!target->isRegistered() || (_operOnly && !target->isOperator()))
+    {
+        return false;
+    }
+    if (_matcher.getKind() == WhoMask::MASK_ALL)
+    {
+        return true;
+    }
+    if (_matcher.matches(target->getNickname()) || _matcher.matches(target->getUsername()) ||
+        _matcher.matches(target->getRealname()) || _matcher.matches(_server->getServerName()))
+    {
+        return true;
+    }
+
+    // Beaucoup de clients partagent un hôte: le motif n'est évalué qu'une fois par hôte
+    const std::string& host = target->getHostname();
+    std::map<std::string, bool>::iterator it = _hostVerdicts.find(host);
+    if (it == _hostVerdicts.end())
+    {
+        it = _hostVerdicts.insert(std::make_pair(host, _matcher.matches(host))).first;
+    }
+    return it->second;
+}
+
+/**
+ * Avance au prochain client à examiner (le masque est appliqué par pump pour WHO_MASK)
+ * return Client suivant, ou NULL quand la réponse est complète
+ */
+Client* WhoStream::next()
+{
+    if (_target != WHO_MASK)
+    {
+        // Les membres partis ou renommés depuis la requête sont sautés
+        Channel* channel = (_target == WHO_CHANNEL) ? _server->getChannel(_mask) : NULL;
+        while (_nextMember < _members.size())
+        {
+            Client* target = _server->getClientByNickname(_members[_nextMember++]);
+            if (target && (!channel || channel->hasClient(target)) &&
+                (!_operOnly || target->isOperator()))
+            {
+                return target;
+            }
+        }
+        return NULL;
+    }
+
+    Client* target = _server->getClientAfter(_cursor);
+    if (target)
+    {
+        _cursor = target->getFd();
+    }
+    return target;
+}
+
+/**
+ * Met en forme une ligne 352 (WHO) ou 354 (WHOX)
+ * arg client Client qui a demandé la liste
+ * arg target Client décrit
+ * arg channel Canal demandé (NULL pour une recherche par masque)
+ * return Ligne de réponse
+ */
+std::string WhoStream::formatLine(Client* client, Client* target, Channel* channel) const
+{
+    std::string channelName = channel ? channel->getName() : "*";
+    std::string flags = target->isAway() ? "G" : "H";
+    if (target->isOperator())
+    {
+        flags += "*";
+    }
+    if (channel && channel->isOperator(target))
+    {
+        flags += "@";
+    }
+    else if (channel && channel->hasVoice(target))
+    {
+        flags += "+";
+    }
+
+    if (_fields.empty())
+    {
+        return "352 " + client->getNickname() + " " + channelName + " " + target->getUsername() + " " +
+               target->getHostname() + " " + _server->getServerName() + " " + target->getNickname() + " " +
+               flags + " :0 " + target->getRealname();
+    }
+
+    std::string line = "354 " + client->getNickname();
+    for (const char* field = WHOX_FIELDS; *field; ++field)
+    {
+        if (_fields.find(*field) == std::string::npos)
+        {
+            continue;
+        }
+        switch (*field)
+        {
+            case 't': line += " " + _token; break;
+            case 'c': line += " " + channelName; break;
+            case 'u': line += " " + target->getUsername(); break;
+            case 'i':
+                // L'adresse réelle n'est montrée qu'à l'intéressé et aux opérateurs
+                if ((client == target || client->isOperator()) && target->getListener() &&
+                    !target->getListener()->isUnix())
+                {
+                    line += " " + Admission::formatAddress(target->getAddress());
+                }
+                else
+                {
+                    line += " 255.255.255.255";
+                }
+                break;
+            case 'h': line += " " + target->getHostname(); break;
+            case 's': line += " " + _server->getServerName(); break;
+            case 'n': line += " " + target->getNickname(); break;
+            case 'f': line += " " + flags; break;
+            case 'd': line += " 0"; break;
+            case 'l': line += " " + Utils::sizeToString(static_cast<size_t>(target->getIdleTime())); break;
+            case 'a': line += " 0"; break;
+            case 'o': line += " n/a"; break;
+            case 'r': line += " :" + target->getRealname(); break;
+        }
+    }
+    return line;
+}
+
+/**
+ * Émet les lignes de la réponse WHO
+ * arg client Client qui a demandé la liste
+ * arg budget Nombre de lignes encore autorisées pour ce tour
+ * return true quand la réponse est terminée
+ */
+bool WhoStream::pump(Client* client, unsigned int& budget)
+{
+    if (!_started)
+    {
+        start(client);
+        _started = true;
+    }
+
+    // Le nombre de clients examinés est borné aussi: un masque sélectif reprend au tour suivant depuis _cursor
+    Channel* channel = (_target == WHO_CHANNEL) ? _server->getChannel(_mask) : NULL;
+    unsigned int scanned = 0;
+    while (budget > 0 && scanned < WHO_SCAN_PER_TURN)
+    {
+        Client* target = next();
+        if (target == NULL)
+        {
+            client->sendReply("315 " + client->getNickname() + " " + _mask + " :End of WHO list");
+            return true;
+        }
+        scanned++;
+
+        if (_target == WHO_MASK && !matches(target))
+        {
+            continue;
+        }
+        client->sendReply(formatLine(client, target, channel));
+        budget--;
+    }
+    return false;
+}
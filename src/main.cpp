@@ -28,6 +28,19 @@ void signalHandler(int signal)
     g_running = false;
 }
 
+/**
+ * Gestionnaire de SIGHUP: le MOTD sera relu par la boucle du serveur
+ * arg signal Le signal reçu (SIGHUP)
+ */
+void reloadHandler(int signal)
+{
+    (void)signal;
+    if (g_server)
+    {
+        g_server->requestMotdReload();
+    }
+}
+
 /**
  * Configure les gestionnaires de signaux
  */
@@ -49,6 +62,16 @@ void setupSignalHandlers()
     {
         Utils::logMessage("Impossible de configurer le gestionnaire pour SIGTERM", true);
     }
+
+    // Configurer le gestionnaire pour SIGHUP (rechargement du MOTD)
+    struct sigaction reload;
+    reload.sa_handler = reloadHandler;
+    reload.sa_flags = 0;
+    sigemptyset(&reload.sa_mask);
+    if (sigaction(SIGHUP, &reload, NULL) == -1)
+    {
+        Utils::logMessage("Impossible de configurer le gestionnaire pour SIGHUP", true);
+    }
 }
 
 /**
@@ -59,6 +82,12 @@ void showUsage(const std::string& programName)
     std::cout << "Usage: " << programName << " <port> <password>" << std::endl;
     std::cout << "  <port>     : Le port sur lequel le serveur écoute (1024-65535)" << std::endl;
     std::cout << "  <password> : Le mot de passe pour se connecter au serveur" << std::endl;
+    std::cout << "Traçage optionnel: IRC_TRACE_FILE=<fichier> IRC_TRACE_SAMPLE=<1 ligne sur N>" << std::endl;
+    std::cout << "  (analyse: make trace_report && ./trace_report <fichier>)" << std::endl;
+    std::cout << "File d'attente de listen: IRC_LISTEN_BACKLOG=<connexions> (défaut " << LISTEN_BACKLOG_DEFAULT << ", max somaxconn)" << std::endl;
+    std::cout << "Comptes opérateur: " << OPER_CONFIG_FILE << " (<nom> <mot de passe> par ligne, commande OPER)" << std::endl;
+    std::cout << "Message du jour: " << MOTD_FILE << " (relu sur SIGHUP)" << std::endl;
+    std::cout << "Ports supplémentaires: " << LISTENER_CONFIG_FILE << " (<adresse> <port> | unix:<chemin>, options backlog=N reuseport class=nom max=N trusted mode=0660)" << std::endl;
 }
 
 /**
@@ -0,0 +1,193 @@
+#include <iostream>     // Pour l'affichage du rapport
+#include <fstream>      // Pour la lecture du fichier de trace
+#include <iomanip>      // Pour l'alignement des colonnes
+#include <string>       // Pour les chaînes de caractères
+#include <vector>       // Pour les échantillons de latence
+#include <map>          // Pour regrouper les enregistrements par trace
+#include <deque>        // Pour apparier les mises en file et les envois
+#include <algorithm>    // Pour std::sort
+#include <cstring>      // Pour memcmp
+
+#include "../includes/Tracer.hpp"
+
+// Étapes de la ligne d'origine (émetteur)
+struct LineSpan
+{
+    int         fd;         // Client émetteur
+    uint64_t    recv;       // Réception (recv)
+    uint64_t    parse;      // Extraction de la ligne
+    uint64_t    execute;    // Début de l'exécution
+    uint64_t    done;       // Fin de l'exécution
+    uint64_t    lastSend;   // Dernier envoi complet lié à la ligne
+
+    LineSpan() : fd(-1), recv(0), parse(0), execute(0), done(0), lastSend(0) {}
+};
+
+// Échantillons de latence d'une étape (microsecondes)
+struct Stage
+{
+    std::string             name;
+    std::vector<uint64_t>   samples;
+};
+
+/**
+ * Ajoute un échantillon si les deux instants sont connus
+ * arg stage Étape concernée
+ * arg from Instant de début
+ * arg to Instant de fin
+ */
+static void addSample(Stage& stage, uint64_t from, uint64_t to)
+{
+    if (from != 0 && to != 0 && to >= from)
+    {
+        stage.samples.push_back(to - from);
+    }
+}
+
+/**
+ * Calcule un percentile sur des échantillons triés
+ * arg sorted Échantillons triés
+ * arg percent Percentile voulu (0-100)
+ * return Valeur du percentile
+ */
+static uint64_t percentile(const std::vector<uint64_t>& sorted, unsigned int percent)
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+    size_t index = (sorted.size() - 1) * percent / 100;
+    return sorted[index];
+}
+
+/**
+ * Affiche une ligne du rapport pour une étape
+ * arg stage Étape à afficher
+ */
+static void printStage(Stage& stage)
+{
+    std::vector<uint64_t>& s = stage.samples;
+    std::sort(s.begin(), s.end());
+
+    uint64_t total = 0;
+    for (size_t i = 0; i < s.size(); ++i)
+    {
+        total += s[i];
+    }
+
+    std::cout << std::left << std::setw(22) << stage.name << std::right
+              << std::setw(9) << s.size()
+              << std::setw(11) << (s.empty() ? 0 : total / s.size())
+              << std::setw(11) << percentile(s, 50)
+              << std::setw(11) << percentile(s, 99)
+              << std::setw(11) << (s.empty() ? 0 : s.back()) << std::endl;
+}
+
+/**
+ * Lit un fichier de trace produit par le serveur et affiche la répartition des latences
+ */
+int main(int argc, char* argv[])
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <fichier de trace>" << std::endl;
+        return 1;
+    }
+
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file)
+    {
+        std::cerr << "Erreur: impossible d'ouvrir " << argv[1] << std::endl;
+        return 1;
+    }
+
+    char magic[8];
+    if (!file.read(magic, 8) || memcmp(magic, TRACE_MAGIC, 8) != 0)
+    {
+        std::cerr << "Erreur: " << argv[1] << " n'est pas un fichier de trace" << std::endl;
+        return 1;
+    }
+
+    Stage recvWait, dispatch, execute, senderQueue, recipientQueue, endToEnd;
+    recvWait.name = "recv -> parse";
+    dispatch.name = "parse -> execute";
+    execute.name = "execute";
+    senderQueue.name = "sendq (emetteur)";
+    recipientQueue.name = "sendq (destinataires)";
+    endToEnd.name = "recv -> dernier send";
+
+    std::map<uint32_t, LineSpan> lines;
+    // Mises en file en attente d'envoi, par (trace, fd) dans l'ordre d'arrivée
+    std::map<std::pair<uint32_t, int>, std::deque<uint64_t> > pending;
+    unsigned long records = 0;
+    unsigned long unsent = 0;
+
+    TraceRecord rec;
+    while (file.read(reinterpret_cast<char*>(&rec), sizeof(rec)))
+    {
+        records++;
+        LineSpan& line = lines[rec.traceId];
+        switch (rec.event)
+        {
+            case TRACE_RECV:
+                line.fd = rec.fd;
+                line.recv = rec.timestamp;
+                break;
+            case TRACE_PARSE:
+                line.parse = rec.timestamp;
+                break;
+            case TRACE_EXECUTE:
+                line.execute = rec.timestamp;
+                break;
+            case TRACE_DONE:
+                line.done = rec.timestamp;
+                break;
+            case TRACE_ENQUEUE:
+                pending[std::make_pair(rec.traceId, static_cast<int>(rec.fd))].push_back(rec.timestamp);
+                break;
+            case TRACE_SEND:
+            {
+                std::deque<uint64_t>& queue = pending[std::make_pair(rec.traceId, static_cast<int>(rec.fd))];
+                if (queue.empty())
+                {
+                    break;
+                }
+                addSample(rec.fd == line.fd ? senderQueue : recipientQueue, queue.front(), rec.timestamp);
+                queue.pop_front();
+                if (rec.timestamp > line.lastSend)
+                {
+                    line.lastSend = rec.timestamp;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    for (std::map<uint32_t, LineSpan>::iterator it = lines.begin(); it != lines.end(); ++it)
+    {
+        addSample(recvWait, it->second.recv, it->second.parse);
+        addSample(dispatch, it->second.parse, it->second.execute);
+        addSample(execute, it->second.execute, it->second.done);
+        addSample(endToEnd, it->second.recv, it->second.lastSend);
+    }
+    for (std::map<std::pair<uint32_t, int>, std::deque<uint64_t> >::iterator it = pending.begin(); it != pending.end(); ++it)
+    {
+        unsent += it->second.size();
+    }
+
+    std::cout << records << " enregistrements, " << lines.size() << " lignes tracees, "
+              << unsent << " messages jamais envoyes" << std::endl;
+    std::cout << std::left << std::setw(22) << "etape (us)" << std::right
+              << std::setw(9) << "nombre" << std::setw(11) << "moyenne"
+              << std::setw(11) << "p50" << std::setw(11) << "p99"
+              << std::setw(11) << "max" << std::endl;
+    printStage(recvWait);
+    printStage(dispatch);
+    printStage(execute);
+    printStage(senderQueue);
+    printStage(recipientQueue);
+    printStage(endToEnd);
+    return 0;
+}